@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// One bit per cell of a width x height grid, each row padded to whole 64-bit
+// words with bit x of a row at (word x / 64, bit x % 64). Padding bits stay 0,
+// so shifting a row by one never brings in a cell from outside the grid and
+// a whole plane can be combined with another a word at a time.
+// reset() keeps the buffer, like DisjointSet.
+class BitGrid
+{
+public:
+    void reset(int width, int height)
+    {
+        m_width = width;
+        m_height = height;
+        m_wordsPerRow = (width + 63) / 64;
+        m_words.assign(static_cast<std::size_t>(m_wordsPerRow) * height, 0);
+    }
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    int getWordsPerRow() const { return m_wordsPerRow; }
+
+    bool test(int x, int y) const { return (row(y)[x >> 6] >> (x & 63)) & 1; }
+    void set(int x, int y) { row(y)[x >> 6] |= std::uint64_t(1) << (x & 63); }
+
+    std::uint64_t* row(int y) { return m_words.data() + static_cast<std::size_t>(y) * m_wordsPerRow; }
+    const std::uint64_t* row(int y) const { return m_words.data() + static_cast<std::size_t>(y) * m_wordsPerRow; }
+
+    void clearRows(int begin, int end)
+    {
+        for (int y = begin; y < end; ++y)
+            for (int w = 0; w < m_wordsPerRow; ++w)
+                row(y)[w] = 0;
+    }
+
+    // cells of word w that are inside the grid
+    std::uint64_t wordMask(int w) const
+    {
+        const int bits = m_width - w * 64;
+        return bits >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1;
+    }
+
+    // set cells from (x, y) rightwards before the first clear one
+    int runLength(int x, int y) const
+    {
+        const std::uint64_t* cells = row(y);
+        int w = x >> 6;
+        const int length = lowestBit(~(cells[w] >> (x & 63)));
+        if (length < 64 - (x & 63))
+            return length;
+
+        int total = 64 - (x & 63);
+        for (++w; w < m_wordsPerRow && cells[w] == ~std::uint64_t(0); ++w)
+            total += 64;
+        return w < m_wordsPerRow ? total + lowestBit(~cells[w]) : total;
+    }
+
+    static int countBits(std::uint64_t word)
+    {
+#ifdef _MSC_VER
+        return static_cast<int>(__popcnt64(word));
+#else
+        // the bit-twiddled count, __builtin_popcountll is a library call
+        // unless the target has popcnt
+        word -= (word >> 1) & 0x5555555555555555ull;
+        word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+        return static_cast<int>((word * 0x0101010101010101ull) >> 56);
+#endif
+    }
+
+    // index of the lowest set bit, word must not be 0
+    static int lowestBit(std::uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    int m_wordsPerRow = 0;
+    std::vector<std::uint64_t> m_words;
+};
@@ -0,0 +1,129 @@
+#include "CaveGenerator.h"
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    // each bit of a byte spread to a whole byte, so 8 wall bits become 8
+    // TileGrid tiles with one store (tiles are little-endian in a word)
+    struct ByteSpread
+    {
+        std::uint64_t bytes[256];
+    };
+
+    constexpr ByteSpread makeByteSpread()
+    {
+        ByteSpread spread{};
+        for (int value = 0; value < 256; ++value)
+            for (int bit = 0; bit < 8; ++bit)
+                if (value & (1 << bit))
+                    spread.bytes[value] |= std::uint64_t(TileGrid::Wall) << (bit * 8);
+        return spread;
+    }
+
+    constexpr ByteSpread BYTE_SPREAD = makeByteSpread();
+
+    // the row's tiles plus their left and right neighbours, added per bit:
+    // sum = ones + 2 * twos
+    void rowSum(const std::uint64_t* row, int w, int words, std::uint64_t& ones, std::uint64_t& twos)
+    {
+        const std::uint64_t middle = row[w];
+        std::uint64_t left = middle << 1; // tile x - 1 at bit x
+        if (w > 0)
+            left |= row[w - 1] >> 63;
+        std::uint64_t right = middle >> 1; // tile x + 1 at bit x
+        if (w < words - 1)
+            right |= row[w + 1] << 63;
+
+        ones = left ^ middle ^ right;
+        twos = (left & middle) | (right & (left ^ middle));
+    }
+}
+
+void CaveGenerator::generate(TileGrid& tiles, int width, int height, Rng& rng)
+{
+    m_cells.reset(width, height);
+    m_next.reset(width, height);
+    const int words = m_cells.getWordsPerRow();
+
+    // noise, all four draws whatever the room size so the stream stays in step
+    for (int y = 0; y < height; ++y)
+    {
+        std::uint64_t* row = m_cells.row(y);
+        const bool edge = y == 0 || y == height - 1;
+        for (int w = 0; w < words; ++w)
+        {
+            // one statement each, so the draws happen in the same order on every compiler
+            const std::uint64_t r0 = rng.next();
+            const std::uint64_t r1 = rng.next();
+            const std::uint64_t r2 = rng.next();
+            const std::uint64_t r3 = rng.next();
+            row[w] = (edge ? ~std::uint64_t(0) : noise(width, height, r0, r1, r2, r3)) & m_cells.wordMask(w);
+        }
+        row[0] |= 1;
+        row[(width - 1) >> 6] |= std::uint64_t(1) << ((width - 1) & 63);
+    }
+
+    for (int pass = 0; pass < PASSES; ++pass)
+        smooth();
+
+    tiles.resize(width, height);
+    for (int y = 0; y < height; ++y)
+    {
+        const std::uint64_t* bits = m_cells.row(y);
+        std::uint8_t* row = tiles.row(y);
+        for (int x = 0; x < width; x += 8)
+        {
+            const std::uint64_t spread = BYTE_SPREAD.bytes[(bits[x >> 6] >> (x & 63)) & 0xFF];
+            const int count = width - x < 8 ? width - x : 8;
+            std::memcpy(row + x, &spread, static_cast<std::size_t>(count));
+        }
+    }
+}
+
+// one smoothing pass from m_cells into m_next, then swapped
+void CaveGenerator::smooth()
+{
+    const int width = m_cells.getWidth();
+    const int height = m_cells.getHeight();
+    const int words = m_cells.getWordsPerRow();
+
+    // top and bottom rows stay wall
+    std::memcpy(m_next.row(0), m_cells.row(0), words * sizeof(std::uint64_t));
+    std::memcpy(m_next.row(height - 1), m_cells.row(height - 1), words * sizeof(std::uint64_t));
+
+    for (int y = 1; y < height - 1; ++y)
+    {
+        const std::uint64_t* above = m_cells.row(y - 1);
+        const std::uint64_t* middle = m_cells.row(y);
+        const std::uint64_t* below = m_cells.row(y + 1);
+        std::uint64_t* out = m_next.row(y);
+        for (int w = 0; w < words; ++w)
+        {
+            std::uint64_t a0, a1, m0, m1, b0, b1;
+            rowSum(above, w, words, a0, a1);
+            rowSum(middle, w, words, m0, m1);
+            rowSum(below, w, words, b0, b1);
+
+            // above + middle, 0..6 in three bits
+            const std::uint64_t s0 = a0 ^ m0;
+            const std::uint64_t c0 = a0 & m0;
+            const std::uint64_t s1 = a1 ^ m1 ^ c0;
+            const std::uint64_t s2 = (a1 & m1) | (c0 & (a1 ^ m1));
+
+            // + below, 0..9 in four bits
+            const std::uint64_t t0 = s0 ^ b0;
+            const std::uint64_t k0 = s0 & b0;
+            const std::uint64_t t1 = s1 ^ b1 ^ k0;
+            const std::uint64_t k1 = (s1 & b1) | (k0 & (s1 ^ b1));
+            const std::uint64_t t2 = s2 ^ k1;
+            const std::uint64_t t3 = s2 & k1;
+
+            // 5 or more walls of 9
+            out[w] = (t3 | (t2 & (t1 | t0))) & m_next.wordMask(w);
+        }
+        out[0] |= 1;
+        out[(width - 1) >> 6] |= std::uint64_t(1) << ((width - 1) & 63);
+    }
+    std::swap(m_cells, m_next);
+}
@@ -0,0 +1,182 @@
+#include "Collision.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // gap left between a box and the wall it stops against, right and bottom
+    // edges are inclusive so a box flush with a tile would still touch it
+    const float SKIN = 0.01f;
+}
+
+void CollisionGrid::build(const TileGrid& tiles, float tileWidth, float tileHeight)
+{
+    m_width = tiles.getWidth();
+    m_height = tiles.getHeight();
+    m_words = (m_width + 63) / 64;
+    m_tileWidth = tileWidth;
+    m_tileHeight = tileHeight;
+    m_invTileWidth = 1.f / tileWidth;
+    m_invTileHeight = 1.f / tileHeight;
+
+    // assign keeps the buffer when the next room is the same size
+    m_rows.assign(static_cast<std::size_t>(m_words) * m_height, 0);
+    for (int y = 0; y < m_height; ++y)
+    {
+        const std::uint8_t* src = tiles.row(y);
+        std::uint64_t* dst = m_rows.data() + static_cast<std::size_t>(y) * m_words;
+        for (int x = 0; x < m_width; ++x)
+        {
+            if (src[x] == TileGrid::Wall)
+                dst[x >> 6] |= 1ull << (x & 63);
+        }
+    }
+}
+
+bool CollisionGrid::isSolid(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+        return false;
+    return (m_rows[static_cast<std::size_t>(y) * m_words + (x >> 6)] >> (x & 63)) & 1;
+}
+
+bool CollisionGrid::overlaps(const Aabb& box) const
+{
+    if (m_rows.empty())
+        return false;
+    return anySolid(column(box.left), column(box.left + box.width),
+        row(box.top), row(box.top + box.height));
+}
+
+std::uint8_t CollisionGrid::move(Aabb& box, float dx, float dy) const
+{
+    if (m_rows.empty())
+    {
+        box.left += dx;
+        box.top += dy;
+        return 0;
+    }
+
+    std::uint8_t blocked = 0;
+    if (moveX(box, dx))
+        blocked |= BlockedX;
+    if (moveY(box, dy))
+        blocked |= BlockedY;
+    return blocked;
+}
+
+int CollisionGrid::column(float x) const
+{
+    int c = static_cast<int>(std::floor(x * m_invTileWidth));
+    return std::max(0, std::min(m_width - 1, c));
+}
+
+int CollisionGrid::row(float y) const
+{
+    int r = static_cast<int>(std::floor(y * m_invTileHeight));
+    return std::max(0, std::min(m_height - 1, r));
+}
+
+bool CollisionGrid::anySolid(int x0, int x1, int y0, int y1) const
+{
+    const int firstWord = x0 >> 6;
+    const int lastWord = x1 >> 6;
+    const std::uint64_t firstMask = ~0ull << (x0 & 63);
+    const std::uint64_t lastMask = ~0ull >> (63 - (x1 & 63));
+
+    for (int y = y0; y <= y1; ++y)
+    {
+        const std::uint64_t* bits = m_rows.data() + static_cast<std::size_t>(y) * m_words;
+        for (int w = firstWord; w <= lastWord; ++w)
+        {
+            std::uint64_t mask = ~0ull;
+            if (w == firstWord)
+                mask &= firstMask;
+            if (w == lastWord)
+                mask &= lastMask;
+            if (bits[w] & mask)
+                return true;
+        }
+    }
+    return false;
+}
+
+// sweeps the leading edge one tile column at a time so fast boxes can't
+// tunnel, a box that already overlaps a wall is let out rather than stuck
+bool CollisionGrid::moveX(Aabb& box, float dx) const
+{
+    if (dx == 0.f)
+        return false;
+
+    const int y0 = row(box.top);
+    const int y1 = row(box.top + box.height);
+
+    if (dx > 0.f)
+    {
+        const int from = column(box.left + box.width);
+        const int to = column(box.left + box.width + dx);
+        for (int c = from + 1; c <= to; ++c)
+        {
+            if (anySolid(c, c, y0, y1))
+            {
+                box.left = std::max(box.left, c * m_tileWidth - box.width - SKIN);
+                return true;
+            }
+        }
+    }
+    else
+    {
+        const int from = column(box.left);
+        const int to = column(box.left + dx);
+        for (int c = from - 1; c >= to; --c)
+        {
+            if (anySolid(c, c, y0, y1))
+            {
+                box.left = std::min(box.left, (c + 1) * m_tileWidth);
+                return true;
+            }
+        }
+    }
+
+    box.left += dx;
+    return false;
+}
+
+bool CollisionGrid::moveY(Aabb& box, float dy) const
+{
+    if (dy == 0.f)
+        return false;
+
+    const int x0 = column(box.left);
+    const int x1 = column(box.left + box.width);
+
+    if (dy > 0.f)
+    {
+        const int from = row(box.top + box.height);
+        const int to = row(box.top + box.height + dy);
+        for (int r = from + 1; r <= to; ++r)
+        {
+            if (anySolid(x0, x1, r, r))
+            {
+                box.top = std::max(box.top, r * m_tileHeight - box.height - SKIN);
+                return true;
+            }
+        }
+    }
+    else
+    {
+        const int from = row(box.top);
+        const int to = row(box.top + dy);
+        for (int r = from - 1; r >= to; --r)
+        {
+            if (anySolid(x0, x1, r, r))
+            {
+                box.top = std::min(box.top, (r + 1) * m_tileHeight);
+                return true;
+            }
+        }
+    }
+
+    box.top += dy;
+    return false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "TileGrid.h"
+#include <cstdint>
+#include <vector>
+
+// Axis aligned box in world units, same layout as sf::FloatRect
+struct Aabb
+{
+    float left;
+    float top;
+    float width;
+    float height;
+};
+
+inline bool intersects(const Aabb& a, const Aabb& b)
+{
+    return a.left < b.left + b.width && b.left < a.left + a.width
+        && a.top < b.top + b.height && b.top < a.top + a.height;
+}
+
+// Solid tiles of one room packed as a bitmask per row, scaled to world units.
+// Built once when the room is entered, queries never touch the tile grid.
+// Boxes past the room edge see the border tiles, so open doors stay walkable.
+class CollisionGrid
+{
+public:
+    // bits returned by move()
+    enum Blocked : std::uint8_t { BlockedX = 1, BlockedY = 2 };
+
+    void build(const TileGrid& tiles, float tileWidth, float tileHeight);
+
+    bool empty() const { return m_rows.empty(); }
+    float getTileWidth() const { return m_tileWidth; }
+    float getTileHeight() const { return m_tileHeight; }
+
+    bool isSolid(int x, int y) const;
+    bool overlaps(const Aabb& box) const;
+
+    // moves along x then y, an axis that hits a wall stops flush against it
+    // and the other axis keeps going, so boxes slide along walls
+    std::uint8_t move(Aabb& box, float dx, float dy) const;
+
+private:
+    int column(float x) const;
+    int row(float y) const;
+    // any solid tile in columns [x0, x1] of rows [y0, y1]
+    bool anySolid(int x0, int x1, int y0, int y1) const;
+
+    bool moveX(Aabb& box, float dx) const;
+    bool moveY(Aabb& box, float dy) const;
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_words = 0; // 64 bit words per row
+    float m_tileWidth = 1.f;
+    float m_tileHeight = 1.f;
+    float m_invTileWidth = 1.f;
+    float m_invTileHeight = 1.f;
+    std::vector<std::uint64_t> m_rows;
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Union-find over indices 0..size-1 with path halving. A component's root is
+// its lowest index, so every parent is below its child. Joins are made while
+// building; flatten() then points every index straight at its root in one
+// pass in index order, after which find() is one or two loads and the const
+// queries are safe from any number of threads. reset() keeps the buffers, so
+// a generator reusing one never allocates after the first map.
+class DisjointSet
+{
+public:
+    void reset(std::size_t count)
+    {
+        m_parent.resize(count);
+        m_size.assign(count, 1);
+        for (std::size_t i = 0; i < count; ++i)
+            m_parent[i] = static_cast<std::uint32_t>(i);
+        m_components = count;
+    }
+
+    // Lets index stand for size elements (a run of rooms, say), before any
+    // unite(); componentSize() then counts elements rather than indices.
+    void setSize(std::uint32_t index, std::uint32_t size) { m_size[index] = size; }
+
+    // false when a and b were already joined
+    bool unite(std::uint32_t a, std::uint32_t b)
+    {
+        a = compress(a);
+        b = compress(b);
+        if (a == b)
+            return false;
+        if (a > b)
+            std::swap(a, b);
+        m_parent[b] = a;
+        m_size[a] += m_size[b];
+        --m_components;
+        return true;
+    }
+
+    // every index straight to its root; a parent is done before its children
+    void flatten()
+    {
+        for (std::size_t i = 0; i < m_parent.size(); ++i)
+            m_parent[i] = m_parent[m_parent[i]];
+    }
+
+    std::uint32_t find(std::uint32_t index) const
+    {
+        while (m_parent[index] != index)
+            index = m_parent[index];
+        return index;
+    }
+
+    bool connected(std::uint32_t a, std::uint32_t b) const { return find(a) == find(b); }
+    std::uint32_t componentSize(std::uint32_t index) const { return m_size[find(index)]; }
+    std::size_t componentCount() const { return m_components; }
+    std::size_t size() const { return m_parent.size(); }
+
+private:
+    // find that halves the path on the way
+    std::uint32_t compress(std::uint32_t index)
+    {
+        while (m_parent[index] != index)
+        {
+            m_parent[index] = m_parent[m_parent[index]];
+            index = m_parent[index];
+        }
+        return index;
+    }
+
+    std::vector<std::uint32_t> m_parent;
+    std::vector<std::uint32_t> m_size; // only meaningful at roots
+    std::size_t m_components = 0;
+};
@@ -0,0 +1,337 @@
+#include "DoorConnector.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const int STEP_X[4] = { 0, 1, 0, -1 };
+    const int STEP_Y[4] = { -1, 0, 1, 0 };
+
+    // reached bits of a word carried up (to higher bits) through its open
+    // runs: adding a reached bit to a run ripples a carry to the run's end
+    std::uint64_t spreadUp(std::uint64_t reached, std::uint64_t open)
+    {
+        reached &= open;
+        return (((open + reached) ^ open) & open) | reached;
+    }
+
+    // and down, doubling the distance each step
+    std::uint64_t spreadDown(std::uint64_t reached, std::uint64_t open)
+    {
+        reached &= open;
+        reached |= open & (reached >> 1);
+        open &= open >> 1;
+        reached |= open & (reached >> 2);
+        open &= open >> 2;
+        reached |= open & (reached >> 4);
+        open &= open >> 4;
+        reached |= open & (reached >> 8);
+        open &= open >> 8;
+        reached |= open & (reached >> 16);
+        open &= open >> 16;
+        reached |= open & (reached >> 32);
+        return reached;
+    }
+
+    // reached bits of a row spread along its open runs, across words
+    void fillRow(std::uint64_t* reached, const std::uint64_t* open, int words)
+    {
+        std::uint64_t carry = 0;
+        for (int w = 0; w < words; ++w)
+        {
+            reached[w] = spreadUp(reached[w] | (carry & open[w]), open[w]);
+            carry = reached[w] >> 63;
+        }
+        carry = 0;
+        for (int w = words - 1; w >= 0; --w)
+        {
+            reached[w] = spreadDown(reached[w] | (carry & open[w]), open[w]);
+            carry = (reached[w] & 1) << 63;
+        }
+    }
+
+    // the row takes in the open tiles under the reached ones of the row next
+    // to it and spreads them along; true if it gained any
+    bool growRow(std::uint64_t* reached, const std::uint64_t* open, const std::uint64_t* from, int words)
+    {
+        std::uint64_t added = 0;
+        for (int w = 0; w < words; ++w)
+            added |= from[w] & open[w] & ~reached[w];
+        if (added == 0)
+            return false;
+        for (int w = 0; w < words; ++w)
+            reached[w] |= from[w] & open[w];
+        fillRow(reached, open, words);
+        return true;
+    }
+
+    // Grows reached over open until it stops. Rows lo..hi hold the new seeds,
+    // the rest must already be closed. Sweeps down then up, each carrying on
+    // past the rows still to be passed on for as long as rows keep gaining,
+    // so a fill that stays in a few rows only sweeps those. lo..hi come back
+    // widened to every row that gained.
+    void flood(BitGrid& reached, const BitGrid& open, int& lo, int& hi)
+    {
+        const int height = open.getHeight();
+        const int words = open.getWordsPerRow();
+        for (int y = lo; y <= hi; ++y)
+            fillRow(reached.row(y), open.row(y), words);
+
+        // rows whose neighbour below / above has yet to see what they gained
+        int downLo = lo, downHi = hi;
+        int upLo = lo, upHi = hi;
+        while (downLo <= downHi || upLo <= upHi)
+        {
+            for (int y = downLo + 1; y < height && downLo <= downHi; ++y)
+            {
+                if (growRow(reached.row(y), open.row(y), reached.row(y - 1), words))
+                {
+                    upLo = std::min(upLo, y);
+                    upHi = std::max(upHi, y);
+                    hi = std::max(hi, y);
+                }
+                else if (y > downHi)
+                    break;
+            }
+            downLo = height;
+            downHi = -1;
+
+            for (int y = upHi - 1; y >= 0 && upLo <= upHi; --y)
+            {
+                if (growRow(reached.row(y), open.row(y), reached.row(y + 1), words))
+                {
+                    downLo = std::min(downLo, y);
+                    downHi = std::max(downHi, y);
+                    lo = std::min(lo, y);
+                }
+                else if (y < upLo)
+                    break;
+            }
+            upLo = height;
+            upHi = -1;
+        }
+    }
+
+    // word w of row y with each bit also set by its 4 neighbours
+    std::uint64_t grownWord(const BitGrid& grid, int y, int w)
+    {
+        const int words = grid.getWordsPerRow();
+        const std::uint64_t* row = grid.row(y);
+        std::uint64_t grown = row[w] | row[w] << 1 | row[w] >> 1;
+        if (w > 0)
+            grown |= row[w - 1] >> 63;
+        if (w < words - 1)
+            grown |= row[w + 1] << 63;
+        if (y > 0)
+            grown |= grid.row(y - 1)[w];
+        if (y < grid.getHeight() - 1)
+            grown |= grid.row(y + 1)[w];
+        return grown & grid.wordMask(w);
+    }
+}
+
+int DoorConnector::connect(TileGrid& tiles, const Door* doors, int count)
+{
+    if (count == 0)
+        return 0;
+
+    pack(tiles);
+    const int width = tiles.getWidth();
+    const int height = tiles.getHeight();
+    m_reached.reset(width, height);
+    m_reached.set(doors[0].x, doors[0].y);
+    int lo = doors[0].y;
+    int hi = doors[0].y;
+    flood(m_reached, m_floor, lo, hi);
+
+    int carved = 0;
+    for (int i = 1; i < count; ++i)
+        if (!m_reached.test(doors[i].x, doors[i].y))
+            carved += carve(tiles, doors[i]);
+
+    // wall in the floor no door reaches
+    const int words = m_floor.getWordsPerRow();
+    for (int y = 0; y < height; ++y)
+    {
+        const std::uint64_t* floor = m_floor.row(y);
+        const std::uint64_t* reached = m_reached.row(y);
+        for (int w = 0; w < words; ++w)
+        {
+            for (std::uint64_t sealed = floor[w] & ~reached[w]; sealed != 0; sealed &= sealed - 1)
+                tiles.set(w * 64 + BitGrid::lowestBit(sealed), y, TileGrid::Wall);
+        }
+    }
+    return carved;
+}
+
+// floor bits from the tiles, 8 at a time: the multiply moves the low bit of
+// byte i (a Wall tile is 1) to bit 56 + i without any two products colliding
+void DoorConnector::pack(const TileGrid& tiles)
+{
+    const int width = tiles.getWidth();
+    const int height = tiles.getHeight();
+    m_floor.reset(width, height);
+    for (int y = 0; y < height; ++y)
+    {
+        const std::uint8_t* row = tiles.row(y);
+        std::uint64_t* bits = m_floor.row(y);
+        for (int w = 0; w < m_floor.getWordsPerRow(); ++w)
+        {
+            const int begin = w * 64;
+            const int end = begin + 64 < width ? begin + 64 : width;
+            std::uint64_t walls = 0;
+            int x = begin;
+            for (; x + 8 <= end; x += 8)
+            {
+                std::uint64_t bytes;
+                std::memcpy(&bytes, row + x, 8);
+                walls |= ((bytes * 0x0102040810204080ull) >> 56) << (x - begin);
+            }
+            for (; x < end; ++x)
+                walls |= std::uint64_t(row[x]) << (x - begin);
+            bits[w] = ~walls & m_floor.wordMask(w);
+        }
+    }
+}
+
+// The fewest walls between door and the reached floor. The door's floor is
+// level 0; each level opens every wall next to the last (never the border)
+// and floods on through them, until one of the opened walls touches
+// m_reached. Then back down the levels: the next wall to carve is either
+// next to the last one or across floor first reached on its level.
+int DoorConnector::carve(TileGrid& tiles, Door door)
+{
+    const int width = tiles.getWidth();
+    const int height = tiles.getHeight();
+    const int words = m_floor.getWordsPerRow();
+
+    m_open = m_floor;
+    m_search.reset(width, height);
+    m_search.set(door.x, door.y);
+    int top = door.y; // rows the search has reached
+    int bottom = door.y;
+    flood(m_search, m_open, top, bottom);
+
+    int levels = 0;
+    if (m_levels.empty())
+        m_levels.emplace_back();
+    m_levels[0] = m_search;
+
+    // inside the border
+    auto inner = [this, width, words](int w)
+    {
+        std::uint64_t mask = m_floor.wordMask(w);
+        if (w == 0)
+            mask &= ~std::uint64_t(1);
+        if (w == words - 1)
+            mask &= ~(std::uint64_t(1) << ((width - 1) & 63));
+        return mask;
+    };
+
+    Door wall{ -1, -1 };
+    while (wall.x < 0)
+    {
+        int lo = height;
+        int hi = -1;
+        for (int y = std::max(1, top - 1); y <= std::min(height - 2, bottom + 1); ++y)
+        {
+            for (int w = 0; w < words; ++w)
+            {
+                // all walls, any floor next to the search is in it already
+                const std::uint64_t opened = grownWord(m_search, y, w) & ~m_search.row(y)[w] & inner(w);
+                if (opened == 0)
+                    continue;
+                m_open.row(y)[w] |= opened;
+                lo = std::min(lo, y);
+                hi = y;
+                const std::uint64_t meeting = opened & grownWord(m_reached, y, w);
+                if (meeting != 0 && wall.x < 0)
+                    wall = { w * 64 + BitGrid::lowestBit(meeting), y };
+            }
+        }
+        if (hi < 0)
+            return 0; // walled off by the border, only a broken room does that
+        if (wall.x >= 0)
+            break;
+
+        for (int y = lo; y <= hi; ++y)
+            for (int w = 0; w < words; ++w)
+                m_search.row(y)[w] |= m_open.row(y)[w] & ~m_floor.row(y)[w];
+        flood(m_search, m_open, lo, hi);
+        top = std::min(top, lo);
+        bottom = std::max(bottom, hi);
+        if (++levels == static_cast<int>(m_levels.size()))
+            m_levels.emplace_back();
+        m_levels[levels] = m_search;
+    }
+
+    // first reached on level
+    auto onLevel = [this](int level, int x, int y)
+    {
+        return m_levels[level].test(x, y) && (level == 0 || !m_levels[level - 1].test(x, y));
+    };
+
+    int carved = 0;
+    int lo = door.y;
+    int hi = door.y;
+    for (int level = levels;; --level)
+    {
+        tiles.set(wall.x, wall.y, TileGrid::Floor);
+        m_floor.set(wall.x, wall.y);
+        m_reached.set(wall.x, wall.y);
+        lo = std::min(lo, wall.y);
+        hi = std::max(hi, wall.y);
+        ++carved;
+        if (level == 0)
+            break;
+
+        // a wall of the level below next to this one...
+        Door next{ -1, -1 };
+        Door floor{ -1, -1 };
+        for (int step = 0; step < 4 && next.x < 0; ++step)
+        {
+            const int x = wall.x + STEP_X[step];
+            const int y = wall.y + STEP_Y[step];
+            if (!onLevel(level, x, y))
+                continue;
+            if (m_floor.test(x, y))
+                floor = { x, y };
+            else
+                next = { x, y };
+        }
+
+        // ...or one on the far side of that level's floor
+        if (next.x < 0)
+        {
+            if (floor.x < 0)
+                break; // can't happen, the level below is what reached this wall
+            // the level's floor, with a closed row either side of it
+            for (int y = std::max(0, top - 1); y <= std::min(height - 1, bottom + 1); ++y)
+                for (int w = 0; w < words; ++w)
+                    m_open.row(y)[w] = m_floor.row(y)[w] & m_levels[level].row(y)[w];
+            m_search.reset(width, height);
+            m_search.set(floor.x, floor.y);
+            int floorLo = floor.y;
+            int floorHi = floor.y;
+            flood(m_search, m_open, floorLo, floorHi);
+            for (int y = std::max(1, floorLo - 1); y <= std::min(height - 2, floorHi + 1) && next.x < 0; ++y)
+            {
+                for (int w = 0; w < words; ++w)
+                {
+                    const std::uint64_t walls = m_levels[level].row(y)[w] & ~m_levels[level - 1].row(y)[w]
+                        & ~m_floor.row(y)[w] & grownWord(m_search, y, w);
+                    if (walls != 0)
+                    {
+                        next = { w * 64 + BitGrid::lowestBit(walls), y };
+                        break;
+                    }
+                }
+            }
+        }
+        wall = next;
+    }
+
+    m_reached.set(door.x, door.y);
+    flood(m_reached, m_floor, lo, hi);
+    return carved;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BitGrid.h"
+#include "TileGrid.h"
+
+// Makes sure every door of a room interior can be walked to from every
+// other. The check is a flood fill from the first door over the room's floor
+// as row bitmasks: each row spreads its reached bits along its floor runs a
+// word at a time, then the rows next to it pick them up, sweeping down and
+// up for as long as rows keep gaining. A connected room costs that and
+// nothing more. A door left out gets the fewest wall tiles between it and
+// the reached floor carved away, found by growing the door's floor a wall at
+// a time with the same fill. Floor no door reaches is walled in, so nothing
+// spawns sealed off.
+//
+// Keeps its scratch between calls, one per thread when used from the
+// interior pool.
+class DoorConnector
+{
+public:
+    struct Door
+    {
+        int x = 0;
+        int y = 0;
+    };
+
+    // doors are floor tiles on the border; returns the tiles carved
+    int connect(TileGrid& tiles, const Door* doors, int count);
+
+private:
+    void pack(const TileGrid& tiles);
+    int carve(TileGrid& tiles, Door door);
+
+    BitGrid m_floor;
+    BitGrid m_reached; // from the first door
+
+    // carve() scratch
+    BitGrid m_open; // floor, plus the walls the search has gone through
+    BitGrid m_search;
+    std::vector<BitGrid> m_levels; // reached from the door through at most i walls
+};
@@ -0,0 +1,248 @@
+#include "DungeonFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using Room = MapGenerator::Room;
+
+    std::size_t tileBytesPerRoom(int roomWidth, int roomHeight)
+    {
+        return (static_cast<std::size_t>(roomWidth) * roomHeight + 7) / 8;
+    }
+
+    // one bit per tile, row-major, wall = 1
+    void packTiles(const TileGrid& tiles, std::uint8_t* out)
+    {
+        std::size_t bit = 0;
+        for (int y = 0; y < tiles.getHeight(); ++y)
+        {
+            const std::uint8_t* row = tiles.row(y);
+            for (int x = 0; x < tiles.getWidth(); ++x, ++bit)
+                out[bit >> 3] |= static_cast<std::uint8_t>((row[x] == TileGrid::Wall) << (bit & 7));
+        }
+    }
+}
+
+std::uint8_t DungeonFile::packRoom(const MapGenerator::Room& room)
+{
+    std::uint8_t bits = 0;
+    if (room.active)    bits |= Active;
+    if (room.exitUp)    bits |= ExitUp;
+    if (room.exitDown)  bits |= ExitDown;
+    if (room.exitLeft)  bits |= ExitLeft;
+    if (room.exitRight) bits |= ExitRight;
+    return static_cast<std::uint8_t>(bits | (static_cast<std::uint8_t>(room.type) << TYPE_SHIFT));
+}
+
+std::size_t DungeonFile::fileSize(int roomsX, int roomsY, int roomWidth, int roomHeight)
+{
+    const std::size_t rooms = static_cast<std::size_t>(roomsX) * roomsY;
+    return sizeof(Header) + rooms + rooms * tileBytesPerRoom(roomWidth, roomHeight);
+}
+
+bool DungeonFile::save(const MapGenerator& map, const char* path)
+{
+    const int roomsX = map.getRoomsX();
+    const int roomsY = map.getRoomsY();
+    const std::size_t rooms = static_cast<std::size_t>(roomsX) * roomsY;
+    const int roomWidth = map.getRoomWidth();
+    const int roomHeight = map.getRoomHeight();
+    const std::size_t tileBytes = tileBytesPerRoom(roomWidth, roomHeight);
+
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.seed = map.getSeed();
+    header.roomsX = static_cast<std::uint32_t>(roomsX);
+    header.roomsY = static_cast<std::uint32_t>(roomsY);
+    header.roomWidth = static_cast<std::uint16_t>(roomWidth);
+    header.roomHeight = static_cast<std::uint16_t>(roomHeight);
+    header.tileBytes = static_cast<std::uint32_t>(tileBytes);
+    header.startX = map.getStartRoom().x;
+    header.startY = map.getStartRoom().y;
+    header.bossX = map.getBossRoom().x;
+    header.bossY = map.getBossRoom().y;
+    header.roomsOffset = sizeof(Header);
+    header.tilesOffset = sizeof(Header) + rooms;
+
+    // the whole file in memory so it goes out in a single write
+    std::vector<std::uint8_t> buffer(fileSize(roomsX, roomsY, roomWidth, roomHeight), 0);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    std::uint8_t* roomBytes = buffer.data() + header.roomsOffset;
+    std::uint8_t* tileBits = buffer.data() + header.tilesOffset;
+    for (int y = 0; y < roomsY; ++y)
+    {
+        for (int x = 0; x < roomsX; ++x)
+        {
+            const Room& room = map.getRoom(x, y);
+            *roomBytes++ = packRoom(room);
+            if (room.active)
+                packTiles(room.tiles, tileBits);
+            tileBits += tileBytes;
+        }
+    }
+
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file)
+        return false;
+    const bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    return std::fclose(file) == 0 && written;
+}
+
+DungeonView::~DungeonView()
+{
+    close();
+}
+
+bool DungeonView::open(const char* path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(DungeonFile::Header)))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(DungeonFile::Header)))
+    {
+        ::close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (data == MAP_FAILED)
+        return false;
+    m_size = static_cast<std::size_t>(info.st_size);
+#endif
+    m_data = static_cast<const std::uint8_t*>(data);
+
+    // the only parsing there is: a header copy, a size check and the room bytes
+    std::memcpy(&m_header, m_data, sizeof(m_header));
+    const std::size_t rooms = static_cast<std::size_t>(m_header.roomsX) * m_header.roomsY;
+    const std::size_t tileBits = static_cast<std::size_t>(m_header.roomWidth) * m_header.roomHeight;
+    auto inGrid = [this](std::int32_t x, std::int32_t y)
+    {
+        return x >= 0 && y >= 0 && static_cast<std::uint32_t>(x) < m_header.roomsX
+            && static_cast<std::uint32_t>(y) < m_header.roomsY;
+    };
+    // written so a corrupt header cannot overflow its way past the checks
+    bool valid = m_header.magic == DungeonFile::MAGIC
+        && m_header.version == DungeonFile::VERSION
+        && m_header.roomsX > 0 && m_header.roomsY > 0
+        && inGrid(m_header.startX, m_header.startY)
+        && inGrid(m_header.bossX, m_header.bossY)
+        && tileBits > 0
+        && m_header.tileBytes == (tileBits + 7) / 8
+        && m_header.roomsOffset >= sizeof(m_header)
+        && m_header.tilesOffset <= m_size
+        && m_header.roomsOffset <= m_header.tilesOffset
+        && rooms <= m_header.tilesOffset - m_header.roomsOffset
+        && rooms <= (m_size - m_header.tilesOffset) / m_header.tileBytes;
+
+    // every room byte's type has to be one MapGenerator knows, Start is the last
+    if (valid)
+    {
+        const std::uint8_t* roomBytes = m_data + m_header.roomsOffset;
+        std::uint8_t highest = 0; // no early out, so the loop vectorizes
+        for (std::size_t i = 0; i < rooms; ++i)
+            highest = std::max(highest, roomBytes[i]);
+        valid = (highest >> DungeonFile::TYPE_SHIFT) <= static_cast<int>(RoomType::Start);
+    }
+    if (!valid)
+    {
+        close();
+        return false;
+    }
+
+    m_rooms = m_data + m_header.roomsOffset;
+    m_tiles = m_data + m_header.tilesOffset;
+    return true;
+}
+
+void DungeonView::close()
+{
+    if (!m_data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_rooms = nullptr;
+    m_tiles = nullptr;
+    m_size = 0;
+    m_header = DungeonFile::Header{};
+}
+
+void DungeonView::readRoom(int x, int y, MapGenerator::Room& out) const
+{
+    const std::uint8_t bits = getRoomBits(x, y);
+    out.active = (bits & DungeonFile::Active) != 0;
+    out.type = static_cast<RoomType>(bits >> DungeonFile::TYPE_SHIFT);
+    out.exitUp = (bits & DungeonFile::ExitUp) != 0;
+    out.exitDown = (bits & DungeonFile::ExitDown) != 0;
+    out.exitLeft = (bits & DungeonFile::ExitLeft) != 0;
+    out.exitRight = (bits & DungeonFile::ExitRight) != 0;
+
+    // generate() leaves inactive rooms without tiles, so do the same
+    if (!out.active)
+    {
+        out.tiles.clear();
+        return;
+    }
+
+    const int width = m_header.roomWidth;
+    const int height = m_header.roomHeight;
+    const std::uint8_t* packed = getTileBits(x, y);
+    out.tiles.resize(width, height);
+    std::size_t bit = 0;
+    for (int ty = 0; ty < height; ++ty)
+    {
+        std::uint8_t* row = out.tiles.row(ty);
+        for (int tx = 0; tx < width; ++tx, ++bit)
+            row[tx] = (packed[bit >> 3] >> (bit & 7)) & 1 ? TileGrid::Wall : TileGrid::Floor;
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "MapGenerator.h"
+
+// Binary dungeon save. The file is a fixed header, one byte per room and then
+// every room's tiles packed one bit each, all at fixed offsets:
+//
+//   Header                         64 bytes
+//   room bytes    roomsX*roomsY    bit 0 active, bits 1-4 exits, bits 5-7 type
+//   tile bits     roomsX*roomsY*tileBytes, row-major, bit set = wall
+//
+// Inactive rooms keep their (zero) tile slot so any room is found by index
+// alone. Fields are little-endian, which is every platform the game runs on.
+// save() fills one buffer and writes it in one go; DungeonView maps the file
+// and reads rooms straight out of the mapping.
+namespace DungeonFile
+{
+    static constexpr std::uint32_t MAGIC = 0x4E55445A; // "ZDUN"
+    static constexpr std::uint32_t VERSION = 1;
+
+    // room byte bits
+    enum RoomBits : std::uint8_t
+    {
+        Active = 1, ExitUp = 2, ExitDown = 4, ExitLeft = 8, ExitRight = 16
+    };
+    static constexpr int TYPE_SHIFT = 5;
+
+    struct Header
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t seed;
+        std::uint32_t roomsX;
+        std::uint32_t roomsY;
+        std::uint16_t roomWidth;
+        std::uint16_t roomHeight;
+        std::uint32_t tileBytes; // per room
+        std::int32_t startX;
+        std::int32_t startY;
+        std::int32_t bossX;
+        std::int32_t bossY;
+        std::uint64_t roomsOffset;
+        std::uint64_t tilesOffset;
+    };
+    static_assert(sizeof(Header) == 64, "header layout is part of the format");
+
+    std::uint8_t packRoom(const MapGenerator::Room& room);
+    std::size_t fileSize(int roomsX, int roomsY, int roomWidth, int roomHeight);
+
+    // false when the file could not be written
+    bool save(const MapGenerator& map, const char* path);
+}
+
+// Read-only mapping of a saved dungeon. open() checks the header against the
+// file size and runs one pass over the room bytes, and that is all the
+// loading there is; tiles are read in place, so opening a file of millions of
+// rooms touches a byte each and nothing is allocated per room.
+class DungeonView
+{
+public:
+    using RoomType = MapGenerator::Room::RoomType;
+
+    DungeonView() = default;
+    ~DungeonView();
+
+    DungeonView(const DungeonView&) = delete;
+    DungeonView& operator=(const DungeonView&) = delete;
+
+    // false when the file is missing, truncated or not a version we read
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    std::uint64_t getSeed() const { return m_header.seed; }
+    int getRoomsX() const { return static_cast<int>(m_header.roomsX); }
+    int getRoomsY() const { return static_cast<int>(m_header.roomsY); }
+    int getRoomWidth() const { return m_header.roomWidth; }
+    int getRoomHeight() const { return m_header.roomHeight; }
+    MapGenerator::RoomPos getStartRoom() const { return { m_header.startX, m_header.startY }; }
+    MapGenerator::RoomPos getBossRoom() const { return { m_header.bossX, m_header.bossY }; }
+
+    std::uint8_t getRoomBits(int x, int y) const { return m_rooms[roomIndex(x, y)]; }
+    bool isActive(int x, int y) const { return (getRoomBits(x, y) & DungeonFile::Active) != 0; }
+    RoomType getType(int x, int y) const
+    {
+        return static_cast<RoomType>(getRoomBits(x, y) >> DungeonFile::TYPE_SHIFT);
+    }
+
+    // the room's packed tiles, tileBytes long
+    const std::uint8_t* getTileBits(int x, int y) const
+    {
+        return m_tiles + roomIndex(x, y) * m_header.tileBytes;
+    }
+    bool isWall(int roomX, int roomY, int tileX, int tileY) const
+    {
+        const std::size_t bit = static_cast<std::size_t>(tileY) * m_header.roomWidth + tileX;
+        return (getTileBits(roomX, roomY)[bit >> 3] >> (bit & 7)) & 1;
+    }
+
+    // Unpacks one room into out, reusing its tile buffer
+    void readRoom(int x, int y, MapGenerator::Room& out) const;
+
+private:
+    std::size_t roomIndex(int x, int y) const
+    {
+        return static_cast<std::size_t>(y) * m_header.roomsX + x;
+    }
+
+    DungeonFile::Header m_header{};
+    const std::uint8_t* m_data = nullptr;
+    const std::uint8_t* m_rooms = nullptr;
+    const std::uint8_t* m_tiles = nullptr;
+    std::size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
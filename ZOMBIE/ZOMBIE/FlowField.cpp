@@ -0,0 +1,122 @@
+#include "FlowField.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+    // N, E, S, W, then the diagonals NE, SE, SW, NW
+    const int STEP_X[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+    const int STEP_Y[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+
+    const float DIAGONAL = 0.70710678f;
+    const float UNIT_X[9] = { 0.f, 1.f, 0.f, -1.f, DIAGONAL, DIAGONAL, -DIAGONAL, -DIAGONAL, 0.f };
+    const float UNIT_Y[9] = { -1.f, 0.f, 1.f, 0.f, -DIAGONAL, DIAGONAL, DIAGONAL, -DIAGONAL, 0.f };
+}
+
+bool FlowField::update(const TileGrid& tiles, float tileWidth, float tileHeight, int goalX, int goalY)
+{
+    goalX = std::max(0, std::min(tiles.getWidth() - 1, goalX));
+    goalY = std::max(0, std::min(tiles.getHeight() - 1, goalY));
+    m_invTileWidth = 1.f / tileWidth;
+    m_invTileHeight = 1.f / tileHeight;
+
+    if (std::abs(goalX - m_goalX) <= m_goalSlack && std::abs(goalY - m_goalY) <= m_goalSlack
+        && m_goalX >= 0 && tiles.getWidth() == m_width && tiles.getHeight() == m_height)
+        return false;
+
+    m_goalX = goalX;
+    m_goalY = goalY;
+    build(tiles);
+    return true;
+}
+
+void FlowField::build(const TileGrid& tiles)
+{
+    m_width = tiles.getWidth();
+    m_height = tiles.getHeight();
+    m_stride = m_width + 2;
+    const std::size_t count = static_cast<std::size_t>(m_stride) * (m_height + 2);
+
+    // assign/resize only allocate the first time a room of this size is seen
+    m_distance.assign(count, WALL);
+    m_direction.assign(count, NO_DIRECTION);
+    m_queue.resize(static_cast<std::size_t>(m_width) * m_height);
+
+    for (int y = 0; y < m_height; ++y)
+    {
+        const std::uint8_t* row = tiles.row(y);
+        std::uint32_t* distance = &m_distance[index(0, y)];
+        for (int x = 0; x < m_width; ++x)
+            distance[x] = row[x] == TileGrid::Wall ? WALL : UNREACHABLE;
+    }
+
+    // neighbour offsets in the padded buffer, same order as STEP_X/STEP_Y
+    const std::ptrdiff_t stride = m_stride;
+    std::ptrdiff_t offsets[8];
+    for (int d = 0; d < 8; ++d)
+        offsets[d] = STEP_Y[d] * stride + STEP_X[d];
+
+    // every tile enters the queue at most once, so a flat array is enough
+    std::uint32_t* distance = m_distance.data();
+    std::uint32_t* queue = m_queue.data();
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    const std::uint32_t goal = static_cast<std::uint32_t>(index(m_goalX, m_goalY));
+    distance[goal] = 0;
+    queue[tail++] = goal;
+
+    while (head < tail)
+    {
+        const std::uint32_t current = queue[head++];
+        const std::uint32_t next = distance[current] + 1;
+        for (int d = 0; d < 4; ++d)
+        {
+            const std::size_t n = current + offsets[d];
+            if (distance[n] == UNREACHABLE)
+            {
+                distance[n] = next;
+                queue[tail++] = static_cast<std::uint32_t>(n);
+            }
+        }
+    }
+
+    // each reached tile points at its closest neighbour, diagonals only when
+    // both side tiles are open so agents don't clip wall corners
+    for (std::size_t i = 1; i < tail; ++i)
+    {
+        const std::uint32_t current = queue[i];
+        std::uint32_t best = distance[current];
+        std::uint8_t bestDir = NO_DIRECTION;
+        for (int d = 0; d < 8; ++d)
+        {
+            if (d >= 4 && (distance[current + offsets[d] - STEP_Y[d] * stride] >= WALL
+                || distance[current + offsets[d] - STEP_X[d]] >= WALL))
+                continue;
+
+            const std::uint32_t neighbour = distance[current + offsets[d]];
+            if (neighbour < best)
+            {
+                best = neighbour;
+                bestDir = static_cast<std::uint8_t>(d);
+            }
+        }
+        m_direction[current] = bestDir;
+    }
+}
+
+bool FlowField::sample(float worldX, float worldY, float& dirX, float& dirY) const
+{
+    if (m_distance.empty())
+        return false;
+
+    const int x = std::max(0, std::min(m_width - 1, static_cast<int>(std::floor(worldX * m_invTileWidth))));
+    const int y = std::max(0, std::min(m_height - 1, static_cast<int>(std::floor(worldY * m_invTileHeight))));
+    // only the tile it was built for has no direction; inside the slack the
+    // old field still leads round walls to within a few tiles of the goal
+    const std::uint8_t direction = m_direction[index(x, y)];
+
+    dirX = UNIT_X[direction];
+    dirY = UNIT_Y[direction];
+    return direction != NO_DIRECTION;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "TileGrid.h"
+#include <cstdint>
+#include <vector>
+
+// Distance field over one room towards a goal tile (the player), shared by
+// every agent in the room. Built with a breadth-first search from the goal,
+// then each floor tile stores which neighbour is one step closer, so an
+// agent's lookup is one index. Rebuilt only when the goal leaves the slack
+// square around the tile it was built for; the buffers are kept, so
+// rebuilding does not allocate.
+class FlowField
+{
+public:
+    static constexpr std::uint32_t UNREACHABLE = 0xFFFFFFFFu;
+    static constexpr std::uint8_t NO_DIRECTION = 8;
+
+    // returns true when the field had to be rebuilt
+    bool update(const TileGrid& tiles, float tileWidth, float tileHeight, int goalX, int goalY);
+    // next update() rebuilds, for when the room itself changes
+    void invalidate() { m_goalX = -1; m_goalY = -1; }
+
+    // Tiles the goal may move (on either axis) before the field is rebuilt.
+    // Until then agents keep following the old field, which takes them round
+    // walls to the built goal tile; only on that tile do they get no
+    // direction and head straight at the real goal.
+    void setGoalSlack(int tiles) { m_goalSlack = tiles; }
+
+    bool empty() const { return m_distance.empty(); }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    int getGoalX() const { return m_goalX; }
+    int getGoalY() const { return m_goalY; }
+
+    std::uint32_t getDistance(int x, int y) const
+    {
+        std::uint32_t distance = m_distance[index(x, y)];
+        return distance == WALL ? UNREACHABLE : distance;
+    }
+    std::uint8_t getDirection(int x, int y) const { return m_direction[index(x, y)]; }
+
+    // unit step towards the goal from a world position, false at the goal
+    // or where the goal can't be reached
+    bool sample(float worldX, float worldY, float& dirX, float& dirY) const;
+
+private:
+    void build(const TileGrid& tiles);
+    // the buffers carry a one tile wall border so the search needs no bounds checks
+    std::size_t index(int x, int y) const { return static_cast<std::size_t>(y + 1) * m_stride + x + 1; }
+
+    static constexpr std::uint32_t WALL = UNREACHABLE - 1;
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_stride = 0; // m_width + 2
+    int m_goalX = -1;
+    int m_goalY = -1;
+    int m_goalSlack = 0;
+    float m_invTileWidth = 1.f;
+    float m_invTileHeight = 1.f;
+
+    std::vector<std::uint32_t> m_distance;
+    std::vector<std::uint8_t> m_direction;
+    std::vector<std::uint32_t> m_queue; // tile indices, sized once per room size
+};
@@ -0,0 +1,110 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+namespace
+{
+    const int MAX_SLEEP_SAMPLES = 200;
+}
+
+FramePacer::FramePacer()
+{
+#ifdef _WIN32
+    // 1ms scheduler ticks instead of 15.6ms, or a 1ms sleep is never 1ms
+    timeBeginPeriod(1);
+#endif
+    setTargetFps(m_targetFps);
+    m_deadline = Clock::now();
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::setMode(Mode mode)
+{
+    m_mode = mode;
+    m_deadline = Clock::now();
+}
+
+void FramePacer::setTargetFps(double fps)
+{
+    m_targetFps = std::max(1.0, fps);
+    m_period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / m_targetFps));
+}
+
+const char* FramePacer::getModeName(Mode mode)
+{
+    switch (mode)
+    {
+    case Mode::VSync:    return "vsync";
+    case Mode::Capped:   return "capped";
+    case Mode::Uncapped: return "uncapped";
+    }
+    return "?";
+}
+
+double FramePacer::sleepDeviation() const
+{
+    return m_sleepSamples > 1 ? std::sqrt(m_sleepM2 / (m_sleepSamples - 1)) : 0.0;
+}
+
+void FramePacer::recordSleep(double ms)
+{
+    if (m_sleepSamples >= MAX_SLEEP_SAMPLES)
+    {
+        // forget a sample's worth so the estimate keeps following
+        m_sleepM2 *= static_cast<double>(m_sleepSamples - 1) / m_sleepSamples;
+        --m_sleepSamples;
+    }
+    ++m_sleepSamples;
+    const double delta = ms - m_sleepMean;
+    m_sleepMean += delta / m_sleepSamples;
+    m_sleepM2 += delta * (ms - m_sleepMean);
+}
+
+void FramePacer::wait()
+{
+    Clock::time_point now = Clock::now();
+    if (m_mode != Mode::Capped)
+    {
+        m_deadline = now;
+        return;
+    }
+
+    // whole frames behind (a hitch, a dragged window): start over from now
+    // rather than rushing out frames to catch up
+    m_deadline += m_period;
+    if (now - m_deadline > m_period)
+    {
+        m_deadline = now;
+        return;
+    }
+
+    using Ms = std::chrono::duration<double, std::milli>;
+    while (Ms(m_deadline - now).count() > getSleepEstimateMs())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        Clock::time_point woke = Clock::now();
+        recordSleep(Ms(woke - now).count());
+        now = woke;
+    }
+
+    // the last stretch is shorter than a sleep can be trusted with
+    while (Clock::now() < m_deadline)
+    {
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <chrono>
+
+// How often the game presents a frame. VSync leaves the waiting to the
+// driver and Uncapped doesn't wait at all (benchmarks); both are window
+// settings, so for them wait() only keeps the deadline current. Capped
+// sleeps in 1ms slices while the deadline is comfortably ahead and spins
+// for the rest. How long is "comfortably" is learnt from the sleeps
+// themselves (mean + 2 standard deviations of what a 1ms sleep really
+// took), so the spin stays short on a precise timer and grows on a coarse
+// one instead of overshooting the frame.
+class FramePacer
+{
+public:
+    enum class Mode { VSync, Capped, Uncapped };
+
+    FramePacer();
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    void setMode(Mode mode);
+    Mode getMode() const { return m_mode; }
+    void setTargetFps(double fps);
+    double getTargetFps() const { return m_targetFps; }
+    static const char* getModeName(Mode mode);
+
+    // once per frame, after presenting
+    void wait();
+
+    // estimated real length of a 1ms sleep, in milliseconds
+    double getSleepEstimateMs() const { return m_sleepMean + 2.0 * sleepDeviation(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double sleepDeviation() const;
+    void recordSleep(double ms);
+
+    Mode m_mode = Mode::VSync;
+    double m_targetFps = 144.0;
+    Clock::duration m_period;
+    Clock::time_point m_deadline;
+
+    // running sleep statistics, Welford; the count is capped so old samples
+    // fade and the estimate follows the machine's timer as it changes
+    double m_sleepMean = 1.0;
+    double m_sleepM2 = 0.0;
+    int m_sleepSamples = 1;
+};
@@ -4,21 +4,99 @@
 /// </summary>
 
 #include "Game.h"
-#include <iostream>
+#include "DungeonFile.h"
+#include "Log.h"
+#include "Random.h"
+#include "ResourceCache.h"
+#include <cstdio>
 
+namespace
+{
+	int roomSizeOption(const GameOptions& t_options)
+	{
+		return t_options.roomSize > 0 ? t_options.roomSize : MapGenerator::Room::DEFAULT_SIZE;
+	}
+}
 
-Game::Game() :
-	m_window{ sf::VideoMode{ 1200U, 1000U, 32U }, "SFML Game" },
-	m_mapGenerator(8, 6, 100)
+Game::Game(const GameOptions& t_options) :
+	m_mapGenerator(8, 6, roomSizeOption(t_options), roomSizeOption(t_options)),
+	m_headless(t_options.headless)
 {
-	m_mapGenerator.generate();
+	if (!m_headless)
+	{
+		m_window.create(sf::VideoMode{ WINDOW_WIDTH, WINDOW_HEIGHT, 32U }, "SFML Game");
+	}
+	// a replay brings its own seed and mode
+	bool infiniteDungeon = t_options.infiniteDungeon;
+	std::uint64_t seed = t_options.seed;
+	if (t_options.replayFile)
+	{
+		if (m_replay.load(t_options.replayFile))
+		{
+			m_replaying = true;
+			infiniteDungeon = m_replay.isInfiniteDungeon();
+			seed = m_replay.getSeed();
+			if (m_replay.getRoomWidth() != 0)
+				m_mapGenerator.setRoomSize(m_replay.getRoomWidth(), m_replay.getRoomHeight());
+			LOG_INFO("Replaying {} ticks from {}", m_replay.size(), t_options.replayFile);
+		}
+		else
+		{
+			LOG_ERROR("Could not read replay {}", t_options.replayFile);
+		}
+	}
+
+	if (!m_replaying && t_options.dungeonFile)
+	{
+		// stays mapped for the session, rooms are read as the player gets to them
+		auto saved = std::make_unique<SavedDungeon>();
+		if (saved->open(t_options.dungeonFile))
+		{
+			LOG_INFO("Loaded dungeon {} ({}x{} rooms)", t_options.dungeonFile, saved->getRoomsX(), saved->getRoomsY());
+			m_savedDungeon = std::move(saved);
+		}
+		else
+		{
+			LOG_WARN("Could not load dungeon {}, generating a new one", t_options.dungeonFile);
+		}
+	}
+	if (!m_savedDungeon)
+	{
+		if (seed != 0)
+			m_mapGenerator.generate(seed);
+		else
+			m_mapGenerator.generate();
+	}
 
-	for (int y = 0; y < 6; ++y)
-		for (int x = 0; x < 8; ++x)
-			if (m_mapGenerator.getRoom(x, y).color == sf::Color::Green)
-				m_currentRoom = { x, y };
+	// a room fills the window, whatever size the map's rooms are
+	const int roomWidth = m_savedDungeon ? m_savedDungeon->getRoomWidth() : m_mapGenerator.getRoomWidth();
+	const int roomHeight = m_savedDungeon ? m_savedDungeon->getRoomHeight() : m_mapGenerator.getRoomHeight();
+	m_tileSize = sf::Vector2f(
+		static_cast<float>(WINDOW_WIDTH) / roomWidth,
+		static_cast<float>(WINDOW_HEIGHT) / roomHeight);
+	m_flowField.setGoalSlack(static_cast<int>(FLOW_GOAL_SLACK / std::max(m_tileSize.x, m_tileSize.y)));
 
-	const auto& newRoomObj = m_mapGenerator.getRoom(m_nextRoom.x, m_nextRoom.y);
+	m_recordFile = t_options.recordFile;
+	if (m_recordFile)
+	{
+		m_recording.start(getSeed(), infiniteDungeon, roomWidth, roomHeight);
+	}
+
+	MapGenerator::RoomPos start = m_savedDungeon ? m_savedDungeon->getStartRoom() : m_mapGenerator.getStartRoom();
+	if (infiniteDungeon)
+	{
+		// a loaded file only lends its seed
+		m_streamingDungeon = std::make_unique<StreamingDungeon>(getSeed(), roomWidth, roomHeight);
+		m_savedDungeon.reset();
+		start = m_streamingDungeon->getStartRoom();
+		m_streamingDungeon->update(start);
+	}
+	else if (m_savedDungeon)
+		m_savedDungeon->update(start);
+	m_currentRoom = { start.x, start.y };
+	m_collision.build(getRoom(m_currentRoom).tiles, m_tileSize.x, m_tileSize.y);
+
+	const auto& newRoomObj = getRoom(m_nextRoom);
 
 	int dirX = m_nextRoom.x - m_currentRoom.x;  // -1, 0, or 1
 	int dirY = m_nextRoom.y - m_currentRoom.y;  // -1, 0, or 1
@@ -27,12 +105,77 @@ Game::Game() :
 	m_player.setPosition(doorPos.x, doorPos.y);
 
 
-	m_cameraView = m_window.getDefaultView();
-	m_cameraView.setCenter(m_window.getSize().x / 2.f, m_window.getSize().y / 2.f);
-	//m_lastPlayerPos = m_player.getPosition();
+	m_cameraView.reset(sf::FloatRect(0.f, 0.f, static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT)));
+	m_lastPlayerPos = m_player.getPosition();
+
+	markVisited(m_currentRoom); //start rooms visited
+
+	const float zombieW = ZombieSystem::FRAME_WIDTH * 2.f;
+	const float zombieH = ZombieSystem::FRAME_HEIGHT * 2.f;
+	const float hitW = zombieW * HITBOX_WIDTH_PERCENT;
+	const float hitH = zombieH * HITBOX_HEIGHT_PERCENT;
+	m_zombies.setHitbox((zombieW - hitW) * 0.5f, zombieH - hitH - zombieH * HITBOX_LIFT_PERCENT, hitW, hitH);
+	m_zombies.reserve(BOSS_ROOM_ZOMBIES + ZombiePursuit::MAX_PURSUERS);
+	m_broadphase.configure(m_tileSize.x, m_tileSize.y, roomWidth, roomHeight);
+	spawnZombies(m_currentRoom);
 
-	m_visitedRooms.resize(6, std::vector<bool>(8, false));
-	m_visitedRooms[m_currentRoom.y][m_currentRoom.x] = true; //start rooms visited
+	// zombies follow the player from room to room on the generated fixed
+	// map; the door costs need every room's tiles, which a loaded one keeps
+	// in its file
+	if (!m_streamingDungeon && !m_savedDungeon)
+		m_roomPaths.build(m_mapGenerator);
+
+	// the rest is only for drawing
+	if (m_headless)
+		return;
+
+	// largest the minimap window can get
+	m_miniMapTexture.create(
+		static_cast<unsigned>(MINIMAP_ROOMS_X * (MINIMAP_CELL + MINIMAP_SPACING) + (MINIMAP_PADDING + MINIMAP_OUTLINE) * 2),
+		static_cast<unsigned>(MINIMAP_ROOMS_Y * (MINIMAP_CELL + MINIMAP_SPACING) + (MINIMAP_PADDING + MINIMAP_OUTLINE) * 2));
+
+	m_tileAtlas.build();
+	if (!m_roomSnapshots.create(WINDOW_WIDTH, WINDOW_HEIGHT))
+	{
+		LOG_ERROR("Failed to create room snapshot textures, drawing rooms from their tiles");
+	}
+	// the current room and its neighbours, plus the one a slide may add
+	m_pendingSnapshots.reserve(RoomSnapshots::POOL_SIZE + 1);
+	queueSnapshots();
+	// the first rooms are all drawn before the first frame, where it doesn't show
+	while (!m_pendingSnapshots.empty())
+		updateSnapshots();
+
+	if (!m_player.loadTexture("ASSETS\\IMAGES\\walk.png"))
+	{
+		LOG_ERROR("Failed to load player texture");
+	}
+	if (!m_zombieRenderer.loadTexture("ASSETS\\IMAGES\\walk.png"))
+	{
+		LOG_ERROR("Failed to load zombie texture");
+	}
+
+	if (!m_font.loadFromFile("ASSETS/FONTS/ariblk.ttf"))
+	{
+		LOG_ERROR("Failed to load font");
+	}
+	m_profilerText.setFont(m_font);
+	m_profilerText.setCharacterSize(14);
+	m_profilerText.setFillColor(sf::Color::White);
+	m_profilerText.setOutlineColor(sf::Color::Black);
+	m_profilerText.setOutlineThickness(1.f);
+	m_profilerText.setPosition(WINDOW_WIDTH - 380.f, 20.f);
+
+	applyFramePacing();
+
+	// tile art is in the atlas now, the decoded copies can go
+	ResourceCache& cache = ResourceCache::instance();
+	cache.trim();
+	ResourceCache::Stats stats = cache.getStats();
+	LOG_INFO("startup {} ms, {} files decoded in {} ms on workers, main thread waited {} ms",
+		cache.getElapsedMs(), stats.decoded, stats.decodeMs, stats.waitMs);
+	LOG_INFO("{} textures, {} KiB texture memory, {} shared handles",
+		stats.liveTextures, static_cast<int>(stats.textureBytes / 1024), stats.hits);
 
 }
 
@@ -44,24 +187,139 @@ void Game::run()
 {	
 	sf::Clock clock;
 	sf::Time timeSinceLastUpdate = sf::Time::Zero;
-	const float fps{ 60.0f };
-	sf::Time timePerFrame = sf::seconds(1.0f / fps); // 60 fps
+	sf::Time timePerFrame = sf::seconds(1.0f / TICK_RATE); // 60 fps
 	while (m_window.isOpen())
 	{
+		m_profiler.beginFrame();
 		processEvents(); // as many as possible
 		timeSinceLastUpdate += clock.restart();
+
+		// after a long stall (breakpoint, window drag) catching up would make
+		// the next frame slower still, so run a few ticks and drop the rest
+		const sf::Time maxBacklog = timePerFrame * static_cast<float>(MAX_UPDATES_PER_FRAME);
+		if (timeSinceLastUpdate > maxBacklog)
+		{
+			LOG_DEBUG("dropped {} ms of simulation", (timeSinceLastUpdate - maxBacklog).asMilliseconds());
+			timeSinceLastUpdate = maxBacklog;
+		}
 		while (timeSinceLastUpdate > timePerFrame)
 		{
 			timeSinceLastUpdate -= timePerFrame;
 			processEvents(); // at least 60 fps
 			update(timePerFrame); //60 fps
 		}
-		render(); // as many as possible
+		m_interpolation = timeSinceLastUpdate / timePerFrame;
+		render(); // as often as the pacing mode allows
+		m_profiler.endFrame();
+		m_pacer.wait();
+	}
+
+	if (m_profiler.writeSummaryCsv("profile_summary.csv")
+		&& m_profiler.writeFramesCsv("profile_frames.csv"))
+	{
+		LOG_INFO("Frame profile written to profile_summary.csv / profile_frames.csv");
+	}
+	saveRecording();
+}
+
+bool Game::runHeadless(std::uint64_t t_ticks)
+{
+	if (t_ticks == 0)
+		t_ticks = m_replay.size();
+
+	const sf::Time timePerFrame = sf::seconds(1.0f / TICK_RATE);
+	sf::Clock clock;
+	for (std::uint64_t tick = 0; tick < t_ticks; ++tick)
+	{
+		update(timePerFrame);
+	}
+	const double seconds = std::max(clock.getElapsedTime().asSeconds(), 1e-6f);
+
+	const std::uint64_t hash = getStateHash();
+	LOG_INFO("{} ticks in {} s, {} ticks/s, {}x real time", t_ticks, seconds,
+		t_ticks / seconds, t_ticks / seconds / TICK_RATE);
+	LOG_INFO("final state {}, room {},{}", hash, m_currentRoom.x, m_currentRoom.y);
+	saveRecording();
+
+	// only a replay played to its end has something to compare with
+	if (!m_replaying || t_ticks != m_replay.size())
+		return true;
+	if (hash != m_replay.getFinalHash())
+	{
+		LOG_ERROR("Replay diverged: recorded state {}, got {}", m_replay.getFinalHash(), hash);
+		return false;
+	}
+	LOG_INFO("Replay matches the recording");
+	return true;
+}
+
+// keyboard, or the recording being replayed; recorded either way if asked
+InputFrame Game::readInput()
+{
+	InputFrame input;
+	if (m_replaying)
+	{
+		input = m_replay.get(m_tick);
+	}
+	else if (!m_headless)
+	{
+		if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) input.buttons |= InputFrame::Up;
+		if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) input.buttons |= InputFrame::Down;
+		if (sf::Keyboard::isKeyPressed(sf::Keyboard::A)) input.buttons |= InputFrame::Left;
+		if (sf::Keyboard::isKeyPressed(sf::Keyboard::D)) input.buttons |= InputFrame::Right;
+	}
+
+	if (m_recordFile)
+		m_recording.record(input);
+	++m_tick;
+	return input;
+}
+
+// FNV-1a over everything a tick changes, bit exact
+std::uint64_t Game::getStateHash() const
+{
+	std::uint64_t h = 1469598103934665603ull;
+	auto add = [&h](const void* data, std::size_t size)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			h ^= bytes[i];
+			h *= 1099511628211ull;
+		}
+	};
+
+	const sf::Vector2f position = m_player.getPosition();
+	add(&position, sizeof(position));
+	add(&m_currentRoom, sizeof(m_currentRoom));
+	add(&m_slideOffset, sizeof(m_slideOffset));
+	add(&m_tick, sizeof(m_tick));
+	const std::size_t zombies = m_zombies.size();
+	add(&zombies, sizeof(zombies));
+	add(m_zombies.getX(), zombies * sizeof(float));
+	add(m_zombies.getY(), zombies * sizeof(float));
+	return h;
+}
+
+void Game::saveRecording()
+{
+	if (!m_recordFile)
+		return;
+
+	m_recording.setFinalHash(getStateHash());
+	if (m_recording.save(m_recordFile))
+	{
+		LOG_INFO("{} ticks of input recorded to {}", m_recording.size(), m_recordFile);
+	}
+	else
+	{
+		LOG_ERROR("Failed to write recording {}", m_recordFile);
 	}
 }
 
 void Game::processEvents()
 {
+	ProfileScope profile(m_profiler, Profiler::Events);
 	sf::Event newEvent;
 	while (m_window.pollEvent(newEvent))
 	{
@@ -82,34 +340,78 @@ void Game::processKeys(sf::Event t_event)
 	{
 		m_exitGame = true;
 	}
+	if (sf::Keyboard::F3 == t_event.key.code)
+	{
+		m_showProfiler = !m_showProfiler;
+	}
+	if (sf::Keyboard::F5 == t_event.key.code)
+	{
+		saveDungeon();
+	}
+	if (sf::Keyboard::F6 == t_event.key.code)
+	{
+		switch (m_pacer.getMode())
+		{
+		case FramePacer::Mode::VSync:    setFramePacing(FramePacer::Mode::Capped); break;
+		case FramePacer::Mode::Capped:   setFramePacing(FramePacer::Mode::Uncapped); break;
+		case FramePacer::Mode::Uncapped: setFramePacing(FramePacer::Mode::VSync); break;
+		}
+	}
+}
+
+void Game::setFramePacing(FramePacer::Mode mode, double fps)
+{
+	m_pacer.setMode(mode);
+	if (fps > 0.0)
+		m_pacer.setTargetFps(fps);
+	applyFramePacing();
+}
+
+void Game::applyFramePacing()
+{
+	if (m_headless)
+		return;
+
+	// the driver does the waiting for vsync, the pacer for capped
+	m_window.setVerticalSyncEnabled(m_pacer.getMode() == FramePacer::Mode::VSync);
+	LOG_INFO("frame pacing {} ({} fps cap)", FramePacer::getModeName(m_pacer.getMode()),
+		m_pacer.getTargetFps());
 }
 
 void Game::update(sf::Time t_deltaTime)
 {
+	ProfileScope profile(m_profiler, Profiler::Update);
+
 	if (m_exitGame)
 	{
 		m_window.close();
 	}
 
+	// keep the rooms around the player streamed in ahead of time
+	if (m_streamingDungeon)
+		m_streamingDungeon->update({ m_currentRoom.x, m_currentRoom.y });
+	else if (m_savedDungeon)
+		m_savedDungeon->update({ m_currentRoom.x, m_currentRoom.y });
+
+	// read every tick, sliding or not, so a recording lines up with update() calls
+	const InputFrame input = readInput();
+
 	sf::Vector2f oldPos = m_player.getPosition();
+	m_lastPlayerPos = oldPos;
+	m_lastSlideOffset = m_slideOffset;
 
 	if (m_transitionState != TransitionState::Sliding)
 	{
-		m_player.hadnleInput();
+		m_player.hadnleInput(input);
 		m_player.update(t_deltaTime);
-		std::cout<<oldPos.y<<std::endl;
+		LOG_DEBUG("player y {}", oldPos.y);
 	}
 	sf::FloatRect spriteBounds = m_player.getSpriteBounds();
 
 
-	// Tweakable hitbox % values
-	float hbWidthPercent = 0.30f;
-	float hbHeightPercent = 0.12f;
-	float yOffsetPercent = 0.28f;  // lift hitbox upward
-
-	float hbWidth = spriteBounds.width * hbWidthPercent;
-	float hbHeight = spriteBounds.height * hbHeightPercent;
-	float yOffset = spriteBounds.height * yOffsetPercent;
+	float hbWidth = spriteBounds.width * HITBOX_WIDTH_PERCENT;
+	float hbHeight = spriteBounds.height * HITBOX_HEIGHT_PERCENT;
+	float yOffset = spriteBounds.height * HITBOX_LIFT_PERCENT;
 
 	sf::FloatRect playerBox(
 		spriteBounds.left + (spriteBounds.width - hbWidth) * 0.5f,
@@ -118,26 +420,52 @@ void Game::update(sf::Time t_deltaTime)
 		hbHeight
 	);
 
-	m_debugPlayerBox = playerBox;
+	// resolve the move one axis at a time so the player slides along walls
+	sf::Vector2f delta = m_player.getPosition() - oldPos;
+	Aabb box{ playerBox.left - delta.x, playerBox.top - delta.y, playerBox.width, playerBox.height };
+	const float startLeft = box.left;
+	const float startTop = box.top;
+	m_collision.move(box, delta.x, delta.y);
+	m_player.setPosition(oldPos.x + box.left - startLeft, oldPos.y + box.top - startTop);
 
-	//If this new position collides with wall undo movement
-	if (isCollidingWithWall(playerBox))
-	{
-		m_player.setPosition(oldPos.x, oldPos.y);
+	m_debugPlayerBox = sf::FloatRect(box.left, box.top, box.width, box.height);
 
-		// update bounds after resetting
-		spriteBounds = m_player.getSpriteBounds();
+	if (m_transitionState != TransitionState::Sliding)
+	{
+		ProfileScope zombieProfile(m_profiler, Profiler::Zombies);
+		// zombies walk at the player's feet, the field only changes with the feet's tile
+		const float feetX = box.left + box.width * 0.5f;
+		const float feetY = box.top + box.height * 0.5f;
+		m_pursuit.advance(m_zombies.getSpeed() * t_deltaTime.asSeconds() / std::max(m_tileSize.x, m_tileSize.y),
+			[this](int tileX, int tileY)
+			{
+				const Aabb hitbox = m_zombies.getHitbox();
+				m_zombies.spawn((tileX + 0.5f) * m_tileSize.x - hitbox.left - hitbox.width * 0.5f,
+					(tileY + 0.5f) * m_tileSize.y - hitbox.top - hitbox.height * 0.5f);
+			});
+		m_flowField.update(getRoom(m_currentRoom).tiles, m_tileSize.x, m_tileSize.y,
+			static_cast<int>(std::floor(feetX / m_tileSize.x)),
+			static_cast<int>(std::floor(feetY / m_tileSize.y)));
+		m_zombies.update(t_deltaTime.asSeconds(), feetX, feetY, &m_collision, &m_flowField);
+
+		m_zombies.getHitboxes(m_zombieBoxes);
+		m_broadphase.build(m_zombieBoxes.data(), m_zombieBoxes.size());
+		int contacts = 0;
+		m_broadphase.queryBox(box, [&contacts](std::uint32_t) { ++contacts; });
+		if (contacts != m_zombieContacts)
+		{
+			m_zombieContacts = contacts;
+			LOG_DEBUG("{} zombies touching the player", contacts);
+		}
 	}
 
-
-
 	sf::Vector2f pos = m_player.getPosition();
 	sf::Vector2f size = m_player.getSize();
 	sf::Vector2f center = pos + size / 2.f;
 
-	const auto& current = m_mapGenerator.getRoom(m_currentRoom.x, m_currentRoom.y);
-	const int windowW = m_window.getSize().x;
-	const int windowH = m_window.getSize().y;
+	const auto& current = getRoom(m_currentRoom);
+	const int windowW = WINDOW_WIDTH;
+	const int windowH = WINDOW_HEIGHT;
 	float margin = 40.f;
 
 	// Handle active sliding transition
@@ -169,17 +497,48 @@ void Game::update(sf::Time t_deltaTime)
 			int oldY = m_currentRoom.y;
 			m_currentRoom = m_nextRoom;
 
-			m_visitedRooms[m_currentRoom.y][m_currentRoom.x] = true;
+			markVisited(m_currentRoom);
+			m_miniMapDirty = true;
+
+			// the ones chasing follow, on the fixed map
+			if (m_roomPaths.isBuilt())
+			{
+				const std::uint8_t* state = m_zombies.getState();
+				m_zombies.getHitboxes(m_zombieBoxes);
+				for (std::size_t i = 0; i < m_zombieBoxes.size(); ++i)
+				{
+					if (state[i] != ZombieSystem::Chase)
+						continue;
+					const Aabb& feet = m_zombieBoxes[i];
+					m_pursuit.add({ oldX, oldY },
+						static_cast<int>((feet.left + feet.width * 0.5f) / m_tileSize.x),
+						static_cast<int>((feet.top + feet.height * 0.5f) / m_tileSize.y));
+				}
+			}
 
-			const auto& nextRoom = m_mapGenerator.getRoom(m_currentRoom.x, m_currentRoom.y);
+			const auto& nextRoom = getRoom(m_currentRoom);
+			m_collision.build(nextRoom.tiles, m_tileSize.x, m_tileSize.y);
+			m_flowField.invalidate();
+			spawnZombies(m_currentRoom);
+			queueSnapshots();
 
 			int dirX = m_currentRoom.x - oldX;
 			int dirY = m_currentRoom.y - oldY;
 
 			sf::Vector2f doorPos = getDoorSpawn(nextRoom, dirX, dirY);
 			m_player.setPosition(doorPos.x, doorPos.y);
+			if (m_roomPaths.isBuilt())
+			{
+				// the new room's field is needed next frame anyway, and gives
+				// every pursuer the goal room's leg without a search each
+				m_flowField.update(nextRoom.tiles, m_tileSize.x, m_tileSize.y,
+					static_cast<int>(doorPos.x / m_tileSize.x), static_cast<int>(doorPos.y / m_tileSize.y));
+				m_pursuit.retarget(m_roomPaths, { m_currentRoom.x, m_currentRoom.y }, m_flowField);
+			}
+			m_lastPlayerPos = m_player.getPosition(); // a jump, nothing to blend
 
 			m_slideOffset = { 0.f, 0.f };
+			m_lastSlideOffset = m_slideOffset;
 			m_cameraView.setCenter(windowW / 2.f, windowH / 2.f);
 		}
 
@@ -213,165 +572,252 @@ void Game::update(sf::Time t_deltaTime)
 
 			m_slideStart = m_slideOffset;
 			m_slideTarget = m_slideStart + direction;
+
+			// normally drawn already; if the player beat the queue to the door
+			// it goes first, and is drawn from its tiles until it's done
+			if (!m_headless && !m_roomSnapshots.contains(roomKey(m_nextRoom)))
+				m_pendingSnapshots.push_back(m_nextRoom);
 		}
 	}
 }
 
 sf::Vector2f Game::findSafeSpawn(const MapGenerator::Room& room)
 {
-	const int windowW = m_window.getSize().x;
-	const int windowH = m_window.getSize().y;
-
-	float tileW = (float)windowW / room.width;
-	float tileH = (float)windowH / room.height;
+	float tileW = m_tileSize.x;
+	float tileH = m_tileSize.y;
+	const int width = room.tiles.getWidth();
+	const int height = room.tiles.getHeight();
 
 	//Try the center first
-	int cx = room.width / 2;
-	int cy = room.height / 2;
+	int cx = width / 2;
+	int cy = height / 2;
 
-	if (room.tiles[cy][cx] == 0) //FLOOR
+	if (!room.tiles.isWall(cx, cy))
 	{
 		return { cx * tileW, cy * tileH };
 	}
 
 	//Otherwise search for ANY nearby floor tile
-	for (int y = 1; y < room.height - 1; ++y)
+	for (int y = 1; y < height - 1; ++y)
 	{
-		for (int x = 1; x < room.width - 1; ++x)
+		for (int x = 1; x < width - 1; ++x)
 		{
-			if (room.tiles[y][x] == 0)
+			if (!room.tiles.isWall(x, y))
 			{
 				return { x * tileW, y * tileH };
 			}
 		}
 	}
 
-	return { windowW / 2.f, windowH / 2.f };
+	return { width * tileW / 2.f, height * tileH / 2.f };
 }
 
 sf::Vector2f Game::getDoorSpawn(const MapGenerator::Room& room,
 	int dirX, int dirY)
 {
-	const int windowW = m_window.getSize().x;
-	const int windowH = m_window.getSize().y;
-
-	float tileW = (float)windowW / room.width;
-	float tileH = (float)windowH / room.height;
+	float tileW = m_tileSize.x;
+	float tileH = m_tileSize.y;
+	const int width = room.tiles.getWidth();
+	const int height = room.tiles.getHeight();
 
-	int midX = room.width / 2;
-	int midY = room.height / 2;
+	int midX = width / 2;
+	int midY = height / 2;
 
 	// Coming from left - spawn at left door
 	if (dirX == 1)     return { 1 * tileW,       midY * tileH };
 	// Coming from right - spawn at right door
-	if (dirX == -1)    return { (room.width - 2) * tileW, midY * tileH };
+	if (dirX == -1)    return { (width - 2) * tileW, midY * tileH };
 	// Coming from top - spawn at top door
 	if (dirY == 1)     return { midX * tileW,    1 * tileH };
 	// Coming from bottom - spawn at bottom door
-	if (dirY == -1)    return { midX * tileW,    (room.height - 2) * tileH };
+	if (dirY == -1)    return { midX * tileW,    (height - 2) * tileH };
 
 	return { midX * tileW, midY * tileH };
 }
 
-bool Game::isCollidingWithWall(const sf::FloatRect& playerBox)
+const MapGenerator::Room& Game::getRoom(sf::Vector2i roomPos)
 {
-	const auto& room = m_mapGenerator.getRoom(m_currentRoom.x, m_currentRoom.y);
+	if (m_streamingDungeon)
+		return m_streamingDungeon->getRoom(roomPos.x, roomPos.y);
+	if (m_savedDungeon)
+		return m_savedDungeon->getRoom(roomPos.x, roomPos.y);
+	return m_mapGenerator.getRoom(roomPos.x, roomPos.y);
+}
 
-	const int windowW = m_window.getSize().x;
-	const int windowH = m_window.getSize().y;
+std::uint64_t Game::getSeed() const
+{
+	if (m_streamingDungeon)
+		return m_streamingDungeon->getSeed();
+	return m_savedDungeon ? m_savedDungeon->getSeed() : m_mapGenerator.getSeed();
+}
 
-	float tileW = (float)windowW / room.width;
-	float tileH = (float)windowH / room.height;
+std::uint64_t Game::roomKey(sf::Vector2i roomPos)
+{
+	return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(roomPos.y)) << 32)
+		| static_cast<std::uint32_t>(roomPos.x);
+}
+
+void Game::markVisited(sf::Vector2i roomPos)
+{
+	if (m_streamingDungeon)
+		m_streamingDungeon->markVisited(roomPos.x, roomPos.y);
+	else
+		m_visitedRooms.insert(roomKey(roomPos));
+}
+
+bool Game::isVisited(sf::Vector2i roomPos) const
+{
+	if (m_streamingDungeon)
+		return m_streamingDungeon->isVisited(roomPos.x, roomPos.y);
+	return m_visitedRooms.count(roomKey(roomPos)) != 0;
+}
 
-	// Find which tiles the player is overlapping
-	int leftTile = playerBox.left / tileW;
-	int rightTile = (playerBox.left + playerBox.width) / tileW;
-	int topTile = playerBox.top / tileH;
-	int bottomTile = (playerBox.top + playerBox.height) / tileH;
+// After entering a room: keeps its snapshot and those of the rooms through
+// its doors, one of which the next slide goes to, and queues the ones
+// missing, the current room last so it is drawn first.
+void Game::queueSnapshots()
+{
+	if (m_headless)
+		return;
 
-	// Clamp bounds
-	leftTile = std::max(0, std::min(room.width - 1, leftTile));
-	rightTile = std::max(0, std::min(room.width - 1, rightTile));
-	topTile = std::max(0, std::min(room.height - 1, topTile));
-	bottomTile = std::max(0, std::min(room.height - 1, bottomTile));
+	const auto& room = getRoom(m_currentRoom);
+	const sf::Vector2i steps[4] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+	const bool exits[4] = { room.exitUp, room.exitRight, room.exitDown, room.exitLeft };
 
-	// Check any wall tile
-	for (int y = topTile; y <= bottomTile; ++y)
+	m_pendingSnapshots.clear();
+	m_roomSnapshots.touch(roomKey(m_currentRoom));
+	for (int i = 0; i < 4; ++i)
 	{
-		for (int x = leftTile; x <= rightTile; ++x)
-		{
-			if (room.tiles[y][x] == 1) // wall tile
-			{
-				return true;
-			}
-		}
+		if (!exits[i])
+			continue;
+		const sf::Vector2i next = m_currentRoom + steps[i];
+		if (m_roomSnapshots.contains(roomKey(next)))
+			m_roomSnapshots.touch(roomKey(next));
+		else
+			m_pendingSnapshots.push_back(next);
 	}
-
-	return false;
+	if (!m_roomSnapshots.contains(roomKey(m_currentRoom)))
+		m_pendingSnapshots.push_back(m_currentRoom);
 }
 
-void Game::render()
+// one band of the last queued snapshot, the queue is only rooms next to the
+// player so getRoom() has them to hand
+void Game::updateSnapshots()
 {
-	m_window.setView(m_cameraView);
-	m_window.clear(sf::Color(50, 50, 50));
+	if (m_pendingSnapshots.empty())
+		return;
+	const sf::Vector2i roomPos = m_pendingSnapshots.back();
+	if (m_roomSnapshots.contains(roomKey(roomPos))
+		|| m_roomSnapshots.render(roomKey(roomPos), getRoom(roomPos), m_tileSize, m_tileAtlas))
+		m_pendingSnapshots.pop_back();
+}
 
-	const int windowW = m_window.getSize().x;
-	const int windowH = m_window.getSize().y;
+// F5, reload with --load dungeon.zdn
+void Game::saveDungeon()
+{
+	if (m_streamingDungeon)
+	{
+		LOG_WARN("Streamed dungeons are rebuilt from their seed {}, nothing to save", getSeed());
+		return;
+	}
+	if (m_savedDungeon)
+	{
+		LOG_WARN("Playing a loaded dungeon, it is saved already");
+		return;
+	}
 
-	auto drawRoom = [&](const MapGenerator::Room& room, sf::Vector2f offset)
+	if (DungeonFile::save(m_mapGenerator, SAVE_FILE))
+	{
+		LOG_INFO("Dungeon saved to {}", SAVE_FILE);
+	}
+	else
 	{
+		LOG_ERROR("Failed to save dungeon to {}", SAVE_FILE);
+	}
+}
 
-		float tileW = static_cast<float>(windowW) / room.width;
-		float tileH = static_cast<float>(windowH) / room.height;
-		sf::RectangleShape tile(sf::Vector2f(tileW, tileH));
-		
-		for (int i = 0; i < room.height; ++i)
-		{
-			for (int j = 0; j < room.width; ++j)
-			{
+// fills the room with zombies on random floor tiles, the same ones every
+// visit, none in the start room
+void Game::spawnZombies(sf::Vector2i roomPos)
+{
+	m_zombies.clear();
 
-				tile.setPosition(offset.x + j * tileW, offset.y + i * tileH);
+	const auto& room = getRoom(roomPos);
+	if (!room.active || room.type == MapGenerator::Room::RoomType::Start)
+		return;
 
-				const int texSize = 16;
-				int repeatX = static_cast<int>(std::ceil(tileW / texSize));
-				int repeatY = static_cast<int>(std::ceil(tileH / texSize));
-			
-				if (repeatX < 1) repeatX = 1;
-				if (repeatY < 1) repeatY = 1;
+	const int count = room.type == MapGenerator::Room::RoomType::Boss
+		? BOSS_ROOM_ZOMBIES : ZOMBIES_PER_ROOM;
 
-				if (room.tiles[i][j] == 1) // wall
-				{
-					//tile.setTexture(&m_mapGenerator.getWallTexture());
-					//tile.setTextureRect(sf::IntRect(0, 0, texSize * repeatX, texSize * repeatY));
-					tile.setFillColor(sf::Color(40, 40, 40));
-				}
-				else // floor
-				{
-					tile.setFillColor(sf::Color(200, 200, 200));
-					//tile.setTexture(&m_mapGenerator.getFloorTexture());
-					//tile.setTextureRect(sf::IntRect(0, 0, texSize * repeatX, texSize * repeatY));
-				}
+	const Aabb hitbox = m_zombies.getHitbox();
+	Rng rng = Rng::stream(getSeed(), ZOMBIE_SPAWN_STREAM, roomPos.x, roomPos.y);
+	for (int attempt = 0; attempt < count * 4 && static_cast<int>(m_zombies.size()) < count; ++attempt)
+	{
+		int x = 1 + rng.nextInt(room.tiles.getWidth() - 2);
+		int y = 1 + rng.nextInt(room.tiles.getHeight() - 2);
+		if (room.tiles.isWall(x, y))
+			continue;
+
+		// feet in the middle of the tile
+		float centreX = (x + 0.5f) * m_tileSize.x;
+		float centreY = (y + 0.5f) * m_tileSize.y;
+		m_zombies.spawn(centreX - hitbox.left - hitbox.width * 0.5f,
+			centreY - hitbox.top - hitbox.height * 0.5f);
+	}
+}
 
-				m_window.draw(tile);
-			}
-		}
-	};
+void Game::render()
+{
+	// the world's size, not the window's, so a resized window still lines up with update()
+	const int windowW = WINDOW_WIDTH;
+	const int windowH = WINDOW_HEIGHT;
+
+	// draw between the last two ticks so motion is smooth at any frame rate
+	const float alpha = m_interpolation;
+	const sf::Vector2f slide = m_lastSlideOffset + (m_slideOffset - m_lastSlideOffset) * alpha;
+	sf::View camera = m_cameraView;
+	camera.setCenter(windowW / 2.f + slide.x, windowH / 2.f + slide.y);
+	m_window.setView(camera);
+	m_window.clear(sf::Color(50, 50, 50));
 
-	// draw current room
-	drawRoom(m_mapGenerator.getRoom(m_currentRoom.x, m_currentRoom.y), { 0.f, 0.f });
+	// one quad a room, whatever its size, once it has a snapshot
+	auto drawRoom = [&](sf::Vector2i roomPos, sf::Vector2f offset)
+	{
+		m_roomSnapshots.draw(m_window, roomKey(roomPos), getRoom(roomPos), offset, m_tileSize, m_tileAtlas);
+	};
 
-	// draw next room if sliding
-	if (m_transitionState == TransitionState::Sliding)
 	{
-		sf::Vector2f offset(
-			(m_nextRoom.x - m_currentRoom.x) * (float)windowW,
-			(m_nextRoom.y - m_currentRoom.y) * (float)windowH
-		);
-		drawRoom(m_mapGenerator.getRoom(m_nextRoom.x, m_nextRoom.y), offset);
+		ProfileScope profile(m_profiler, Profiler::Rooms);
+
+		// a band of rows a frame, sliding or not, so no frame draws a whole big room
+		updateSnapshots();
+
+		// draw current room
+		drawRoom(m_currentRoom, { 0.f, 0.f });
+
+		// draw next room if sliding
+		if (m_transitionState == TransitionState::Sliding)
+		{
+			sf::Vector2f offset(
+				(m_nextRoom.x - m_currentRoom.x) * (float)windowW,
+				(m_nextRoom.y - m_currentRoom.y) * (float)windowH
+			);
+			drawRoom(m_nextRoom, offset);
+		}
 	}
 
-	//m_mapGenerator.render(m_window);
-	m_player.render(m_window);
+	//drawMapOverview();
+	{
+		ProfileScope profile(m_profiler, Profiler::Zombies);
+		// zombies stand still while sliding, their last step is already drawn
+		m_zombieRenderer.update(m_zombies,
+			m_transitionState == TransitionState::Sliding ? 1.f : alpha);
+		m_window.draw(m_zombieRenderer);
+	}
+	{
+		ProfileScope profile(m_profiler, Profiler::Player);
+		m_player.render(m_window, m_lastPlayerPos + (m_player.getPosition() - m_lastPlayerPos) * alpha);
+	}
 		
 	sf::RectangleShape hb;
 	hb.setPosition(m_debugPlayerBox.left, m_debugPlayerBox.top);
@@ -381,33 +827,157 @@ void Game::render()
 
 	m_window.setView(m_window.getDefaultView());
 
-	drawMiniMap();
+	{
+		ProfileScope profile(m_profiler, Profiler::MiniMap);
+		drawMiniMap();
+	}
+
+	if (m_showProfiler)
+	{
+		ProfileScope profile(m_profiler, Profiler::Overlay);
+		drawProfilerOverlay();
+	}
+
+	{
+		ProfileScope profile(m_profiler, Profiler::Display);
+		m_window.display();
+	}
+}
+
+// F3 overlay, text is only rebuilt a few times a second
+void Game::drawProfilerOverlay()
+{
+	if (m_profilerRefresh.getElapsedTime() > sf::milliseconds(250))
+	{
+		m_profilerRefresh.restart();
+
+		char line[96];
+		std::snprintf(line, sizeof(line), "pacing %s, %.0f fps cap (F6)\n",
+			FramePacer::getModeName(m_pacer.getMode()), m_pacer.getTargetFps());
+		std::string text = line;
+		text += "phase       p50     p95     p99     max  (us)\n";
+		for (int phase = 0; phase < Profiler::PHASE_COUNT; ++phase)
+		{
+			Profiler::Stats stats = m_profiler.getStats(static_cast<Profiler::Phase>(phase));
+			std::snprintf(line, sizeof(line), "%-8s %7.0f %7.0f %7.0f %7.0f\n",
+				Profiler::getPhaseName(static_cast<Profiler::Phase>(phase)),
+				stats.p50, stats.p95, stats.p99, stats.max);
+			text += line;
+		}
+		m_profilerText.setString(text);
+	}
+
+	m_window.draw(m_profilerText);
+}
+
+// debug view of the whole dungeon as coloured blocks
+void Game::drawMapOverview()
+{
+	const float roomSize = 100.f;
+	const float gap = 5.f; // spacing between rooms
+
+	sf::RectangleShape roomShape(sf::Vector2f(roomSize, roomSize));
+
+	for (int y = 0; y < m_mapGenerator.getRoomsY(); ++y)
+	{
+		for (int x = 0; x < m_mapGenerator.getRoomsX(); ++x)
+		{
+			const auto& room = m_mapGenerator.getRoom(x, y);
+			float roomX = x * (roomSize + gap);
+			float roomY = y * (roomSize + gap);
+
+			// draw the room block
+			if (room.active)
+				roomShape.setFillColor(getRoomColor(room.type));
+			else
+				roomShape.setFillColor(sf::Color(30, 30, 30));
+
+			roomShape.setPosition(roomX, roomY);
+			m_window.draw(roomShape);
+
+			// draw connecting corridors that fill the gap exactly
+			if (room.active)
+			{
+				if (room.exitRight)
+				{
+					sf::RectangleShape cor(sf::Vector2f(gap, roomSize / 3.f));
+					cor.setPosition(roomX + roomSize, roomY + roomSize / 3.f);
+					cor.setFillColor(sf::Color(110, 110, 110));
+					m_window.draw(cor);
+				}
+
+				if (room.exitDown)
+				{
+					sf::RectangleShape cor(sf::Vector2f(roomSize / 3.f, gap));
+					cor.setPosition(roomX + roomSize / 3.f, roomY + roomSize);
+					cor.setFillColor(sf::Color(110, 110, 110));
+					m_window.draw(cor);
+				}
+			}
+		}
+	}
+}
 
-	m_window.display();
+sf::Color Game::getRoomColor(MapGenerator::Room::RoomType type)
+{
+	switch (type)
+	{
+	case MapGenerator::Room::RoomType::Start:    return sf::Color::Green;
+	case MapGenerator::Room::RoomType::Boss:     return sf::Color::Red;
+	case MapGenerator::Room::RoomType::Normal:   return sf::Color(100, 100, 150);
+	case MapGenerator::Room::RoomType::Treasure: return sf::Color(200, 180, 60);
+	case MapGenerator::Room::RoomType::Trap:     return sf::Color(180, 60, 60);
+	default:                                     return sf::Color(50, 50, 50);
+	}
 }
 
 void Game::drawMiniMap()
 {
-	const int mapWidth = 8;
-	const int mapHeight = 6;
+	if (m_miniMapDirty)
+	{
+		redrawMiniMap();
+		m_miniMapDirty = false;
+	}
+	m_window.draw(m_miniMapSprite);
+}
+
+// renders the minimap into its texture, only when the current or visited rooms change
+void Game::redrawMiniMap()
+{
+	// window of the room grid around the current room
+	const int roomsX = m_savedDungeon ? m_savedDungeon->getRoomsX() : m_mapGenerator.getRoomsX();
+	const int roomsY = m_savedDungeon ? m_savedDungeon->getRoomsY() : m_mapGenerator.getRoomsY();
+	const int mapWidth = m_streamingDungeon ? MINIMAP_ROOMS_X : std::min(MINIMAP_ROOMS_X, roomsX);
+	const int mapHeight = m_streamingDungeon ? MINIMAP_ROOMS_Y : std::min(MINIMAP_ROOMS_Y, roomsY);
+
+	int originX = m_currentRoom.x - mapWidth / 2;
+	int originY = m_currentRoom.y - mapHeight / 2;
+	if (!m_streamingDungeon)
+	{
+		originX = std::max(0, std::min(originX, roomsX - mapWidth));
+		originY = std::max(0, std::min(originY, roomsY - mapHeight));
+	}
 
-	const float cellSize = 18.f;
-	const float spacing = 2.f;
-	const float padding = 10.f;
+	const float cellSize = MINIMAP_CELL;
+	const float spacing = MINIMAP_SPACING;
+	const float padding = MINIMAP_PADDING;
 
 	//minimap pixel size
 	float mapPixelW = mapWidth * (cellSize + spacing);
 	float mapPixelH = mapHeight * (cellSize + spacing);
 
+	m_miniMapTexture.clear(sf::Color::Transparent);
+
+	// outline is drawn outside the frame, leave room for it
 	sf::RectangleShape frame;
 	frame.setSize(sf::Vector2f(mapPixelW + padding * 2,
 		mapPixelH + padding * 2));
-	frame.setPosition(20.f, 20.f);
+	frame.setPosition(MINIMAP_OUTLINE, MINIMAP_OUTLINE);
 	frame.setFillColor(sf::Color(20, 20, 20, 180));
-	frame.setOutlineThickness(3.f);
+	frame.setOutlineThickness(MINIMAP_OUTLINE);
 	frame.setOutlineColor(sf::Color(200, 200, 200, 180));
 
-	m_window.draw(frame);
+	m_miniMapTexture.draw(frame);
 
 	// Starting position inside frame
 	float startX = frame.getPosition().x + padding;
@@ -420,9 +990,8 @@ void Game::drawMiniMap()
 	{
 		for (int x = 0; x < mapWidth; ++x)
 		{
-			const auto& room = m_mapGenerator.getRoom(x, y);
-
-			bool visited = m_visitedRooms[y][x];
+			sf::Vector2i roomPos(originX + x, originY + y);
+			bool visited = isVisited(roomPos);
 
 			if (!visited)
 			{
@@ -430,30 +999,99 @@ void Game::drawMiniMap()
 			}
 			else
 			{
+				// a loaded room's byte is enough, no need to unpack its tiles, and a
+				// streamed room's summary outlives its chunk
+				StreamingDungeon::RoomSummary room;
+				if (m_savedDungeon)
+				{
+					const std::uint8_t bits = m_savedDungeon->getView().getRoomBits(roomPos.x, roomPos.y);
+					room.active = (bits & DungeonFile::Active) != 0;
+					room.exitUp = (bits & DungeonFile::ExitUp) != 0;
+					room.exitDown = (bits & DungeonFile::ExitDown) != 0;
+					room.exitLeft = (bits & DungeonFile::ExitLeft) != 0;
+					room.exitRight = (bits & DungeonFile::ExitRight) != 0;
+					room.type = m_savedDungeon->getView().getType(roomPos.x, roomPos.y);
+				}
+				else if (m_streamingDungeon)
+				{
+					room = m_streamingDungeon->getSummary(roomPos.x, roomPos.y);
+				}
+				else
+				{
+					const auto& generated = getRoom(roomPos);
+					room.active = generated.active;
+					room.exitUp = generated.exitUp;
+					room.exitDown = generated.exitDown;
+					room.exitLeft = generated.exitLeft;
+					room.exitRight = generated.exitRight;
+					room.type = generated.type;
+				}
+				const bool active = room.active;
+				const MapGenerator::Room::RoomType type = room.type;
+
 				// inactive = dark gray
-				if (!room.active)
+				if (!active)
 					cell.setFillColor(sf::Color(60, 60, 60));
 				else
 					cell.setFillColor(sf::Color(150, 150, 150));
 
 				// start room = green
-				if (room.type == MapGenerator::Room::RoomType::Start)
+				if (type == MapGenerator::Room::RoomType::Start)
 					cell.setFillColor(sf::Color::Green);
 
 				// boss room = red
-				if (room.type == MapGenerator::Room::RoomType::Boss)
+				if (type == MapGenerator::Room::RoomType::Boss)
 					cell.setFillColor(sf::Color::Red);
+
+				// doors as short bars across the gaps
+				if (active)
+				{
+					const float cellX = startX + x * (cellSize + spacing);
+					const float cellY = startY + y * (cellSize + spacing);
+					const float third = cellSize / 3.f;
+					sf::RectangleShape door;
+					door.setFillColor(sf::Color(150, 150, 150));
+					door.setSize(sf::Vector2f(third, spacing));
+					if (room.exitUp)
+					{
+						door.setPosition(cellX + third, cellY - spacing);
+						m_miniMapTexture.draw(door);
+					}
+					if (room.exitDown)
+					{
+						door.setPosition(cellX + third, cellY + cellSize);
+						m_miniMapTexture.draw(door);
+					}
+					door.setSize(sf::Vector2f(spacing, third));
+					if (room.exitLeft)
+					{
+						door.setPosition(cellX - spacing, cellY + third);
+						m_miniMapTexture.draw(door);
+					}
+					if (room.exitRight)
+					{
+						door.setPosition(cellX + cellSize, cellY + third);
+						m_miniMapTexture.draw(door);
+					}
+				}
 			}
 
 			// current room highlight = yellow
-			if (x == m_currentRoom.x && y == m_currentRoom.y)
+			if (roomPos == m_currentRoom)
 				cell.setFillColor(sf::Color(255, 230, 50));
 
 			// Set position inside minimap frame
 			cell.setPosition(startX + x * (cellSize + spacing),
 				startY + y * (cellSize + spacing));
 
-			m_window.draw(cell);
+			m_miniMapTexture.draw(cell);
 		}
 	}
+
+	m_miniMapTexture.display();
+	m_miniMapSprite.setTexture(m_miniMapTexture.getTexture(), true);
+	m_miniMapSprite.setTextureRect(sf::IntRect(0, 0,
+		static_cast<int>(mapPixelW + (padding + MINIMAP_OUTLINE) * 2),
+		static_cast<int>(mapPixelH + (padding + MINIMAP_OUTLINE) * 2)));
+	m_miniMapSprite.setPosition(20.f - MINIMAP_OUTLINE, 20.f - MINIMAP_OUTLINE);
 }
@@ -6,15 +6,51 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include "Collision.h"
+#include "FlowField.h"
+#include "FramePacer.h"
+#include "InputLog.h"
 #include "Player.h"
 #include "MapGenerator.h"
+#include "Profiler.h"
+#include "RoomPathfinder.h"
+#include "RoomSnapshots.h"
+#include "SavedDungeon.h"
+#include "SpatialGrid.h"
+#include "StreamingDungeon.h"
+#include "ZombieRenderer.h"
+#include "ZombiePursuit.h"
+#include "ZombieSystem.h"
+
+// how main starts the game, see the command line in main.cpp
+struct GameOptions
+{
+	bool infiniteDungeon = false; // stream rooms around the player instead of a fixed 8x6 map
+	const char* dungeonFile = nullptr; // restore a map saved with F5 instead of generating one
+	std::uint64_t seed = 0; // 0 = random
+	const char* recordFile = nullptr; // every tick's input is written here at the end
+	const char* replayFile = nullptr; // input (and seed and mode) from a recording instead
+	bool headless = false; // no window or drawing, for runHeadless()
+	int roomSize = 0; // tiles across a room, 0 = the default prefab rooms
+};
 
 class Game
 {
 public:
-	Game();
+	explicit Game(const GameOptions& t_options = GameOptions());
 	~Game();
 	void run();
+	// Steps update() as fast as it will go, no window. Logs ticks per second
+	// and returns false when a replay ends somewhere other than where it was
+	// recorded. 0 ticks runs the whole replay.
+	bool runHeadless(std::uint64_t t_ticks);
+	std::uint64_t getReplayLength() const { return m_replay.size(); }
+	// fps is only used by Capped, 0 keeps the current target
+	void setFramePacing(FramePacer::Mode mode, double fps = 0.0);
 
 private:
 
@@ -24,6 +60,7 @@ private:
 	sf::Vector2f m_slideStart;   // starting camera offset
 	sf::Vector2f m_slideTarget;  // target camera offset
 	sf::Vector2f m_slideOffset;  // current offset during slide
+	sf::Vector2f m_lastSlideOffset; // offset before the last tick
 	sf::Vector2f m_nextOffset;
 	float m_slideSpeed = 800.f;
 
@@ -34,23 +71,108 @@ private:
 
 	void processEvents();
 	void processKeys(sf::Event t_event);
+	InputFrame readInput();
+	std::uint64_t getStateHash() const;
+	void saveRecording();
+	void applyFramePacing();
 	void update(sf::Time t_deltaTime);
 	void render();
 	void drawMiniMap();
-	bool isCollidingWithWall(const sf::FloatRect& playerBox);
+	void redrawMiniMap();
+	void drawMapOverview();
+	void drawProfilerOverlay();
+	static sf::Color getRoomColor(MapGenerator::Room::RoomType type);
 	sf::Vector2f findSafeSpawn(const MapGenerator::Room& room);
 	sf::Vector2f getDoorSpawn(const MapGenerator::Room& room,
 		int dirX, int dirY);
+	void queueSnapshots();
+	void updateSnapshots();
+	void spawnZombies(sf::Vector2i roomPos);
+	void saveDungeon();
+
+	const MapGenerator::Room& getRoom(sf::Vector2i roomPos);
+	static std::uint64_t roomKey(sf::Vector2i roomPos);
+	std::uint64_t getSeed() const;
+	void markVisited(sf::Vector2i roomPos);
+	bool isVisited(sf::Vector2i roomPos) const;
+
+	static const int MINIMAP_ROOMS_X = 8;
+	static const int MINIMAP_ROOMS_Y = 6;
+	static constexpr float MINIMAP_CELL = 18.f;
+	static constexpr float MINIMAP_SPACING = 2.f;
+	static constexpr float MINIMAP_PADDING = 10.f;
+	static constexpr float MINIMAP_OUTLINE = 3.f;
+	static constexpr const char* SAVE_FILE = "dungeon.zdn";
+
+	// feet hitbox as a share of the sprite, for the player and zombies
+	static constexpr float HITBOX_WIDTH_PERCENT = 0.30f;
+	static constexpr float HITBOX_HEIGHT_PERCENT = 0.12f;
+	static constexpr float HITBOX_LIFT_PERCENT = 0.28f; // lift hitbox upward
+
+	// how far (world units) the player walks before the flow field is rebuilt,
+	// about the goal tile of a default room so big rooms chase no worse
+	static constexpr float FLOW_GOAL_SLACK = 48.f;
+
+	static const int ZOMBIES_PER_ROOM = 4;
+	static const int BOSS_ROOM_ZOMBIES = 12;
+	static const std::uint64_t ZOMBIE_SPAWN_STREAM = 200; // Rng salt
 
 	Player m_player;
 	MapGenerator m_mapGenerator;
-	std::vector<std::vector<bool>> m_visitedRooms;
+	std::unique_ptr<StreamingDungeon> m_streamingDungeon; // null for the fixed map
+	std::unique_ptr<SavedDungeon> m_savedDungeon; // --load, played from the file instead of m_mapGenerator
+	std::unordered_set<std::uint64_t> m_visitedRooms; // not for streaming, StreamingDungeon keeps room summaries
+
+	// minimap is cached and only re-rendered when it changes
+	sf::RenderTexture m_miniMapTexture;
+	sf::Sprite m_miniMapSprite;
+	bool m_miniMapDirty{ true };
+
+	// world size of one tile, fixed at startup so it does not follow window resizes
+	sf::Vector2f m_tileSize;
+	CollisionGrid m_collision; // walls of the current room
+	FlowField m_flowField; // current room, towards the player's tile
+
+	ZombieSystem m_zombies; // zombies of the current room
+	RoomPathfinder m_roomPaths; // fixed map only
+	ZombiePursuit m_pursuit; // zombies following the player from rooms left behind
+	ZombieRenderer m_zombieRenderer;
+	SpatialGrid m_broadphase; // zombie hitboxes, rebuilt every tick
+	std::vector<Aabb> m_zombieBoxes;
+	int m_zombieContacts{ 0 }; // zombies touching the player
+
+	TileAtlas m_tileAtlas;
+	RoomSnapshots m_roomSnapshots; // current room and the ones through its doors
+	std::vector<sf::Vector2i> m_pendingSnapshots; // a band a frame, from the back
 	sf::Vector2i m_currentRoom{ 0, 0 };
-	sf::Vector2f m_lastPlayerPos;
+	sf::Vector2f m_lastPlayerPos; // position before the last tick
 
 	sf::FloatRect m_debugPlayerBox;
 
-	sf::RenderWindow m_window; // main SFML window
+	Profiler m_profiler;
+	bool m_showProfiler{ false }; // F3
+
+	FramePacer m_pacer; // F6 cycles the mode
+	float m_interpolation{ 1.f }; // how far render is from the last tick to the next, 0..1
+	static const int MAX_UPDATES_PER_FRAME = 5;
+	static constexpr float TICK_RATE = 60.f; // updates per second, whatever the frame rate
+
+	InputLog m_recording;
+	InputLog m_replay;
+	const char* m_recordFile{ nullptr };
+	bool m_replaying{ false };
+	std::uint64_t m_tick{ 0 }; // updates so far
+
+	sf::Font m_font;
+	sf::Text m_profilerText;
+	sf::Clock m_profilerRefresh;
+
+	// world size of a room, also the window size; the simulation uses this
+	// rather than the window so it runs the same without one
+	static const unsigned WINDOW_WIDTH = 1200U;
+	static const unsigned WINDOW_HEIGHT = 1000U;
+	sf::RenderWindow m_window; // main SFML window, never opened when headless
+	bool m_headless{ false };
 	bool m_exitGame{ false }; // control exiting game
 
 };
@@ -0,0 +1,76 @@
+#include "InputLog.h"
+#include <cstdio>
+#include <cstring>
+
+void InputLog::start(std::uint64_t seed, bool infiniteDungeon, int roomWidth, int roomHeight)
+{
+    m_seed = seed;
+    m_infiniteDungeon = infiniteDungeon;
+    m_roomWidth = roomWidth & 0xFFF;
+    m_roomHeight = roomHeight & 0xFFF;
+    m_finalHash = 0;
+    m_ticks.clear();
+}
+
+bool InputLog::save(const char* path) const
+{
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.seed = m_seed;
+    header.finalHash = m_finalHash;
+    header.flags = (m_infiniteDungeon ? 1u : 0u)
+        | static_cast<std::uint32_t>(m_roomWidth) << 8 | static_cast<std::uint32_t>(m_roomHeight) << 20;
+    header.tickCount = static_cast<std::uint32_t>(m_ticks.size());
+
+    std::vector<std::uint8_t> buffer(sizeof(header) + m_ticks.size());
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    if (!m_ticks.empty())
+        std::memcpy(buffer.data() + sizeof(header), m_ticks.data(), m_ticks.size());
+
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file)
+        return false;
+    const bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    return std::fclose(file) == 0 && written;
+}
+
+bool InputLog::load(const char* path)
+{
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file)
+        return false;
+
+    Header header{};
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+        && header.magic == MAGIC && header.version == VERSION;
+
+    // a corrupt count must not size the buffer, so the file has to hold
+    // that many ticks past the header first
+    if (ok)
+    {
+        const long body = std::ftell(file);
+        ok = body >= 0 && std::fseek(file, 0, SEEK_END) == 0;
+        const long end = ok ? std::ftell(file) : -1;
+        ok = ok && end >= body && static_cast<unsigned long>(end - body) >= header.tickCount
+            && std::fseek(file, body, SEEK_SET) == 0;
+    }
+
+    std::vector<std::uint8_t> ticks;
+    if (ok)
+    {
+        ticks.resize(header.tickCount);
+        ok = ticks.empty() || std::fread(ticks.data(), 1, ticks.size(), file) == ticks.size();
+    }
+    std::fclose(file);
+    if (!ok)
+        return false;
+
+    m_seed = header.seed;
+    m_finalHash = header.finalHash;
+    m_infiniteDungeon = (header.flags & 1u) != 0;
+    m_roomWidth = static_cast<int>((header.flags >> 8) & 0xFFF);
+    m_roomHeight = static_cast<int>(header.flags >> 20);
+    m_ticks.swap(ticks);
+    return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One tick of player input, a bit per button
+struct InputFrame
+{
+    enum Button : std::uint8_t { Up = 1, Down = 2, Left = 4, Right = 8 };
+
+    std::uint8_t buttons = 0;
+
+    bool isDown(Button button) const { return (buttons & button) != 0; }
+};
+
+// Every tick's input of a session, with what it takes to play it back
+// exactly: the map seed, mode and room size it started from, one byte per tick, and a
+// hash of the game state after the last tick so a replay can tell if it
+// went the same way. The simulation only depends on these and the fixed
+// tick length, so the same build replays a session bit for bit.
+//
+// File: 32 byte header then the ticks, written in one go like DungeonFile.
+class InputLog
+{
+public:
+    static constexpr std::uint32_t MAGIC = 0x4E50495A; // "ZIPN"
+    static constexpr std::uint32_t VERSION = 1;
+
+    // forget any ticks and start recording a session
+    // room sizes in tiles, 0 for the default
+    void start(std::uint64_t seed, bool infiniteDungeon, int roomWidth = 0, int roomHeight = 0);
+    void record(InputFrame frame) { m_ticks.push_back(frame.buttons); }
+    void setFinalHash(std::uint64_t hash) { m_finalHash = hash; }
+
+    bool save(const char* path) const;
+    // false (log unchanged) when missing, truncated or another version
+    bool load(const char* path);
+
+    std::uint64_t getSeed() const { return m_seed; }
+    bool isInfiniteDungeon() const { return m_infiniteDungeon; }
+    int getRoomWidth() const { return m_roomWidth; } // 0 for the default
+    int getRoomHeight() const { return m_roomHeight; }
+    std::uint64_t getFinalHash() const { return m_finalHash; }
+    std::size_t size() const { return m_ticks.size(); }
+
+    // no buttons once past the end
+    InputFrame get(std::size_t tick) const
+    {
+        InputFrame frame;
+        if (tick < m_ticks.size())
+            frame.buttons = m_ticks[tick];
+        return frame;
+    }
+
+private:
+    struct Header
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t seed;
+        std::uint64_t finalHash;
+        std::uint32_t flags; // bit 0 infinite dungeon, bits 8-19 / 20-31 room width / height (0 default)
+        std::uint32_t tickCount;
+    };
+    static_assert(sizeof(Header) == 32, "header layout is part of the format");
+
+    std::uint64_t m_seed = 0;
+    std::uint64_t m_finalHash = 0;
+    bool m_infiniteDungeon = false;
+    int m_roomWidth = 0;
+    int m_roomHeight = 0;
+    std::vector<std::uint8_t> m_ticks;
+};
@@ -0,0 +1,124 @@
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+Logger& Logger::instance()
+{
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : m_out(stdout)
+{
+    m_startNs = nowNs();
+    m_writer = std::thread(&Logger::writerLoop, this);
+}
+
+Logger::~Logger()
+{
+    shutdown();
+}
+
+void Logger::shutdown()
+{
+    if (!m_running.exchange(false))
+        return;
+
+    m_writer.join();
+    drain();
+
+    std::uint64_t dropped = getDroppedCount();
+    if (dropped > 0)
+        std::fprintf(m_out, "[log] %llu records dropped, ring was full\n",
+            static_cast<unsigned long long>(dropped));
+    std::fflush(m_out);
+}
+
+std::uint64_t Logger::nowNs() const
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Logger::addArg(LogRecord& record, const char* value)
+{
+    LogArg& arg = record.args[record.argCount++];
+    arg.type = LogArg::Str;
+    arg.strOffset = record.textUsed;
+
+    // copy what fits, always NUL terminated
+    std::size_t room = LogRecord::TEXT_SIZE - record.textUsed;
+    std::size_t length = value ? std::strlen(value) : 0;
+    if (room == 0)
+    {
+        arg.strOffset = LogRecord::TEXT_SIZE - 1;
+        return;
+    }
+    length = std::min(length, room - 1);
+    std::memcpy(record.text + record.textUsed, value, length);
+    record.text[record.textUsed + length] = '\0';
+    record.textUsed = static_cast<std::uint8_t>(record.textUsed + length + 1);
+}
+
+void Logger::writerLoop()
+{
+    while (m_running.load(std::memory_order_acquire))
+    {
+        if (!drain())
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+// writes everything queued so far, returns false if there was nothing
+bool Logger::drain()
+{
+    std::uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    const std::uint64_t head = m_head.load(std::memory_order_acquire);
+    if (tail == head)
+        return false;
+
+    std::string line;
+    for (; tail != head; ++tail)
+    {
+        format(m_ring[tail & (CAPACITY - 1)], line);
+        std::fwrite(line.data(), 1, line.size(), m_out);
+        // hand the slot back as soon as it is formatted
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+    std::fflush(m_out);
+    return true;
+}
+
+void Logger::format(const LogRecord& record, std::string& line) const
+{
+    static const char* const LEVEL_NAMES[] = { "DEBUG", "INFO ", "WARN ", "ERROR" };
+
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "[%10.3f] %s ",
+        (record.timeNs - m_startNs) / 1e9, LEVEL_NAMES[static_cast<int>(record.level)]);
+    line = buffer;
+
+    int argIndex = 0;
+    for (const char* c = record.format; *c; ++c)
+    {
+        if (c[0] != '{' || c[1] != '}' || argIndex >= record.argCount)
+        {
+            line += *c;
+            continue;
+        }
+
+        const LogArg& arg = record.args[argIndex++];
+        switch (arg.type)
+        {
+        case LogArg::Int:    std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(arg.i)); break;
+        case LogArg::UInt:   std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(arg.u)); break;
+        case LogArg::Double: std::snprintf(buffer, sizeof(buffer), "%g", arg.d); break;
+        case LogArg::Str:    line += record.text + arg.strOffset; buffer[0] = '\0'; break;
+        }
+        line += buffer;
+        ++c; // skip the '}'
+    }
+    line += '\n';
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+// Asynchronous logging. The game thread copies a fixed-size record into a
+// lock-free single-producer ring and returns; a background thread does the
+// formatting and the (possibly blocking) write. If the ring is full the
+// record is dropped and counted, the caller never waits.
+//
+// Formats use {} placeholders, up to four arguments:
+//     LOG_INFO("entered room {} {}", x, y);
+// The format must be a string literal, it is stored by pointer.
+// Only the game thread may log (single producer).
+
+enum class LogLevel : std::uint8_t { Debug, Info, Warning, Error };
+
+// levels below ZOMBIE_LOG_LEVEL compile to nothing (0 = Debug ... 3 = Error)
+#ifndef ZOMBIE_LOG_LEVEL
+#ifdef _DEBUG
+#define ZOMBIE_LOG_LEVEL 0
+#else
+#define ZOMBIE_LOG_LEVEL 1
+#endif
+#endif
+
+struct LogArg
+{
+    enum Type : std::uint8_t { Int, UInt, Double, Str };
+
+    Type type;
+    union
+    {
+        std::int64_t i;
+        std::uint64_t u;
+        double d;
+        std::uint32_t strOffset; // into LogRecord::text
+    };
+};
+
+struct LogRecord
+{
+    static const int MAX_ARGS = 4;
+    static const int TEXT_SIZE = 64;
+
+    std::uint64_t timeNs;
+    const char* format;
+    LogLevel level;
+    std::uint8_t argCount;
+    std::uint8_t textUsed;
+    LogArg args[MAX_ARGS];
+    char text[TEXT_SIZE]; // copies of string arguments
+};
+
+class Logger
+{
+public:
+    static Logger& instance();
+
+    template <class... Args>
+    void write(LogLevel level, const char* format, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "too many log arguments");
+
+        const std::uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= CAPACITY)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        LogRecord& record = m_ring[head & (CAPACITY - 1)];
+        record.timeNs = nowNs();
+        record.format = format;
+        record.level = level;
+        record.argCount = 0;
+        record.textUsed = 0;
+        int expand[] = { 0, (addArg(record, args), 0)... };
+        (void)expand;
+
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    // drains what is queued and stops the writer; called at exit
+    void shutdown();
+    std::uint64_t getDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    static const std::uint64_t CAPACITY = 4096; // power of two
+
+    Logger();
+    ~Logger();
+
+    std::uint64_t nowNs() const;
+    void writerLoop();
+    bool drain();
+    void format(const LogRecord& record, std::string& line) const;
+
+    template <class T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+        addArg(LogRecord& record, T value)
+    {
+        LogArg& arg = record.args[record.argCount++];
+        arg.type = LogArg::Int;
+        arg.i = value;
+    }
+
+    template <class T>
+    static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+        addArg(LogRecord& record, T value)
+    {
+        LogArg& arg = record.args[record.argCount++];
+        arg.type = LogArg::UInt;
+        arg.u = value;
+    }
+
+    template <class T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type
+        addArg(LogRecord& record, T value)
+    {
+        LogArg& arg = record.args[record.argCount++];
+        arg.type = LogArg::Double;
+        arg.d = value;
+    }
+
+    static void addArg(LogRecord& record, const char* value);
+    static void addArg(LogRecord& record, const std::string& value) { addArg(record, value.c_str()); }
+
+    LogRecord m_ring[CAPACITY];
+
+    // producer and consumer indices on their own cache lines
+    alignas(64) std::atomic<std::uint64_t> m_head{ 0 };
+    alignas(64) std::atomic<std::uint64_t> m_tail{ 0 };
+    alignas(64) std::atomic<std::uint64_t> m_dropped{ 0 };
+
+    std::atomic<bool> m_running{ true };
+    std::uint64_t m_startNs;
+    std::FILE* m_out;
+    std::thread m_writer;
+};
+
+#if ZOMBIE_LOG_LEVEL <= 0
+#define LOG_DEBUG(...) Logger::instance().write(LogLevel::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if ZOMBIE_LOG_LEVEL <= 1
+#define LOG_INFO(...) Logger::instance().write(LogLevel::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if ZOMBIE_LOG_LEVEL <= 2
+#define LOG_WARN(...) Logger::instance().write(LogLevel::Warning, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if ZOMBIE_LOG_LEVEL <= 3
+#define LOG_ERROR(...) Logger::instance().write(LogLevel::Error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
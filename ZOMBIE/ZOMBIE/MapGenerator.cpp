@@ -1,26 +1,64 @@
 ﻿#include "MapGenerator.h"
-#include <cstdlib>
-#include <ctime>
-#include <queue>
-#include <iostream>
-
-MapGenerator::MapGenerator(int roomsX, int roomsY, int roomSize)
-    : m_roomsX(roomsX), m_roomsY(roomsY), m_roomSize(roomSize)
+#include "CaveGenerator.h"
+#include "DoorConnector.h"
+#include "DungeonFile.h"
+#include "RoomPrefabs.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <utility>
+
+namespace
 {
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
-    m_rooms.resize(m_roomsY, std::vector<Room>(m_roomsX));
-    m_roomShape.setSize(sf::Vector2f((float)m_roomSize, (float)m_roomSize));
+    using Clock = std::chrono::steady_clock;
 
-    if (!m_wallTexture.loadFromFile("ASSETS/IMAGES/wall.png"))
-        std::cout << "Failed to load wall texture\n";
-    if (!m_floorTexture.loadFromFile("ASSETS/IMAGES/floor.png"))
-        std::cout << "Failed to load floor texture\n";
+    // milliseconds since `since`, and restart it
+    double lap(Clock::time_point& since)
+    {
+        Clock::time_point now = Clock::now();
+        double ms = std::chrono::duration<double, std::milli>(now - since).count();
+        since = now;
+        return ms;
+    }
 
+    // The guaranteed path from a random top-row room down to the bottom row,
+    // mark(x, y) for every room on it. Returns the start column.
+    template <typename Mark>
+    int walkMainShaft(Rng& rng, int roomsX, int roomsY, Mark mark)
+    {
+        int startX = rng.nextInt(roomsX);
+        int x = startX;
+        int y = 0;
+
+        mark(x, y);
+
+        while (y < roomsY - 1)
+        {
+            int move = rng.nextInt(3); // 0=left, 1=right, 2=down
+            if (move == 0 && x > 0)
+                x--;
+            else if (move == 1 && x < roomsX - 1)
+                x++;
+            else
+                y++;
 
-    m_wallTexture.setRepeated(true);
-    m_floorTexture.setRepeated(true);
+            mark(x, y);
+        }
+        return startX;
+    }
+}
 
+MapGenerator::MapGenerator(int roomsX, int roomsY, int roomWidth, int roomHeight)
+    : m_roomsX(roomsX), m_roomsY(roomsY)
+{
+    setRoomSize(roomWidth, roomHeight);
+    m_rooms.resize(m_roomsY, std::vector<Room>(m_roomsX));
+}
 
+void MapGenerator::setRoomSize(int width, int height)
+{
+    m_roomWidth = std::clamp(width, static_cast<int>(Room::MIN_SIZE), static_cast<int>(Room::MAX_SIZE));
+    m_roomHeight = std::clamp(height, static_cast<int>(Room::MIN_SIZE), static_cast<int>(Room::MAX_SIZE));
 }
 
 const MapGenerator::Room& MapGenerator::getRoom(int x, int y) const
@@ -29,46 +67,92 @@ const MapGenerator::Room& MapGenerator::getRoom(int x, int y) const
 }
 
 
-// Generate the layout of rooms
+void MapGenerator::setThreadCount(unsigned count)
+{
+    m_pool.reset();
+    if (count != 1)
+        m_pool = std::make_unique<ThreadPool>(count);
+}
+
+// Fresh random dungeon
 void MapGenerator::generate()
 {
+    std::random_device device;
+    std::uint64_t seed = (static_cast<std::uint64_t>(device()) << 32) ^ device();
+    seed ^= static_cast<std::uint64_t>(
+        std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    generate(seed);
+}
+
+// Generate the layout of rooms, then their interiors
+void MapGenerator::generate(std::uint64_t seed)
+{
+    m_seed = seed;
+    if (m_backend == Backend::Bitboard)
+        layoutBitboard(seed);
+    else
+        layoutRooms(seed);
+
+    Clock::time_point phaseStart = Clock::now();
+    const std::size_t roomCount = static_cast<std::size_t>(m_roomsX) * m_roomsY;
+
+    //Generate interior layouts, each from its own stream so order doesn't matter
+    const bool writeRooms = m_backend == Backend::Bitboard;
+    auto buildInteriors = [this, seed, writeRooms](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            int xx = i % m_roomsX;
+            int yy = i / m_roomsX;
+            Room& room = m_rooms[yy][xx];
+            if (writeRooms)
+                writeRoom(room, xx, yy);
+            if (room.active)
+                generateRoomLayout(room, seed, xx, yy, m_roomWidth, m_roomHeight);
+        }
+    };
+
+    if (m_pool)
+        m_pool->parallelFor(static_cast<int>(roomCount), 256, buildInteriors);
+    else
+        buildInteriors(0, static_cast<int>(roomCount));
+    m_phaseTimes.interiors = lap(phaseStart);
+}
+
+void MapGenerator::layoutRooms(std::uint64_t seed)
+{
+    Rng rng = Rng::stream(seed, LayoutStream);
+    Clock::time_point phaseStart = Clock::now();
+
     // --- STEP 0: Reset all rooms ---
     for (int y = 0; y < m_roomsY; ++y)
         for (int x = 0; x < m_roomsX; ++x)
-            m_rooms[y][x] = Room();
+            m_rooms[y][x].reset();
+    m_phaseTimes.reset = lap(phaseStart);
 
     //Build guaranteed downward path (main shaft)
-    int startX = std::rand() % m_roomsX;
+    int startX = walkMainShaft(rng, m_roomsX, m_roomsY,
+        [this](int x, int y) { m_rooms[y][x].active = true; });
     int startY = 0;
-    int x = startX;
-    int y = startY;
-
-    m_rooms[y][x].active = true;
-
-    while (y < m_roomsY - 1)
-    {
-        int move = std::rand() % 3; // 0=left, 1=right, 2=down
-        if (move == 0 && x > 0)
-            x--;
-        else if (move == 1 && x < m_roomsX - 1)
-            x++;
-        else
-            y++;
-
-        m_rooms[y][x].active = true;
-    }
+    m_phaseTimes.mainShaft = lap(phaseStart);
 
     // Random side rooms
     for (int yy = 0; yy < m_roomsY; ++yy)
     {
+        std::uint64_t sideRooms = 0;
         for (int xx = 0; xx < m_roomsX; ++xx)
         {
-            if (!m_rooms[yy][xx].active && std::rand() % 4 == 0)
+            if ((xx & 63) == 0)
+                sideRooms = sideRoomBits(seed, xx >> 6, yy);
+            if ((sideRooms >> (xx & 63)) & 1)
                 m_rooms[yy][xx].active = true;
         }
     }
+    m_phaseTimes.sideRooms = lap(phaseStart);
 
-    //Assign exits between adjacent active rooms
+    //Assign exits between adjacent active rooms, joining them in the index as we go
+    m_indexByRun = false;
+    m_connectivity.reset(static_cast<std::size_t>(m_roomsX) * m_roomsY);
     for (int yy = 0; yy < m_roomsY; ++yy)
     {
         for (int xx = 0; xx < m_roomsX; ++xx)
@@ -80,36 +164,44 @@ void MapGenerator::generate()
             {
                 r.exitRight = true;
                 m_rooms[yy][xx + 1].exitLeft = true;
+                m_connectivity.unite(roomIndex(xx, yy), roomIndex(xx + 1, yy));
             }
             if (yy < m_roomsY - 1 && m_rooms[yy + 1][xx].active)
             {
                 r.exitDown = true;
                 m_rooms[yy + 1][xx].exitUp = true;
+                m_connectivity.unite(roomIndex(xx, yy), roomIndex(xx, yy + 1));
             }
         }
     }
+    m_connectivity.flatten();
+    m_phaseTimes.exits = lap(phaseStart);
 
     // Mark start & boss rooms
-    sf::Vector2i startPos(startX, startY);
+    RoomPos startPos{ startX, startY };
 
     // BFS to find reachable rooms and their distances
-    std::vector<std::vector<int>> dist(m_roomsY, std::vector<int>(m_roomsX, -1));
-    std::queue<sf::Vector2i> q;
-    q.push(startPos);
-    dist[startPos.y][startPos.x] = 0;
-
-    const sf::Vector2i dirs[4] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
-    while (!q.empty())
+    const std::size_t roomCount = static_cast<std::size_t>(m_roomsX) * m_roomsY;
+    m_distance.assign(roomCount, -1);
+    m_queue.clear();
+    m_queue.reserve(m_connectivity.componentSize(roomIndex(startPos.x, startPos.y)));
+    m_queue.push_back(roomIndex(startPos.x, startPos.y));
+    m_distance[m_queue.back()] = 0;
+
+    const RoomPos dirs[4] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
+    for (std::size_t head = 0; head < m_queue.size(); ++head)
     {
-        auto cur = q.front(); q.pop();
+        const RoomPos cur{ static_cast<int>(m_queue[head] % m_roomsX), static_cast<int>(m_queue[head] / m_roomsX) };
         const Room& r = m_rooms[cur.y][cur.x];
+        const int curDist = m_distance[m_queue[head]];
 
         for (auto d : dirs)
         {
             int nx = cur.x + d.x, ny = cur.y + d.y;
             if (nx < 0 || ny < 0 || nx >= m_roomsX || ny >= m_roomsY)
                 continue;
-            if (!m_rooms[ny][nx].active || dist[ny][nx] != -1)
+            const std::uint32_t next = roomIndex(nx, ny);
+            if (!m_rooms[ny][nx].active || m_distance[next] != -1)
                 continue;
 
             // must have matching exits both ways
@@ -118,27 +210,30 @@ void MapGenerator::generate()
             if (d.y == 1 && !(r.exitDown && m_rooms[ny][nx].exitUp)) continue;
             if (d.y == -1 && !(r.exitUp && m_rooms[ny][nx].exitDown)) continue;
 
-            dist[ny][nx] = dist[cur.y][cur.x] + 1;
-            q.push({ nx, ny });
+            m_distance[next] = curDist + 1;
+            m_queue.push_back(next);
         }
     }
 
     // find the farthest reachable cell
-    sf::Vector2i bossPos = startPos;
+    RoomPos bossPos = startPos;
     int maxDist = 0;
     for (int yy = 0; yy < m_roomsY; ++yy)
     {
         for (int xx = 0; xx < m_roomsX; ++xx)
         {
-            if (dist[yy][xx] > maxDist)
+            if (m_distance[roomIndex(xx, yy)] > maxDist)
             {
-                maxDist = dist[yy][xx];
+                maxDist = m_distance[roomIndex(xx, yy)];
                 bossPos = { xx, yy };
             }
         }
     }
+    m_startPos = startPos;
+    m_bossPos = bossPos;
+    m_phaseTimes.bossSearch = lap(phaseStart);
 
-    //assign colors/types
+    //assign types
     for (int yy = 0; yy < m_roomsY; ++yy)
     {
         for (int xx = 0; xx < m_roomsX; ++xx)
@@ -149,77 +244,323 @@ void MapGenerator::generate()
             if (xx == startPos.x && yy == startPos.y)
             {
                 room.type = Room::RoomType::Start;
-                room.color = sf::Color::Green;
             }
             else if (xx == bossPos.x && yy == bossPos.y)
             {
                 room.type = Room::RoomType::Boss;
-                room.color = sf::Color::Red;
             }
             else
             {
-                int r = std::rand() % 100;
-                if (r < 60)
-                {
-                    room.type = Room::RoomType::Normal;
-                    room.color = sf::Color(100, 100, 150);
-                }
-                else if (r < 80)
-                {
-                    room.type = Room::RoomType::Treasure;
-                    room.color = sf::Color(200, 180, 60);
-                }
-                else
-                {
-                    room.type = Room::RoomType::Trap;
-                    room.color = sf::Color(180, 60, 60);
-                }
+                room.type = rollRoomType(seed, xx, yy);
             }
         }
     }
+    m_phaseTimes.roomTypes = lap(phaseStart);
+}
 
-    //Generate interior layouts
-    for (int yy = 0; yy < m_roomsY; ++yy)
+// The same passes over bit planes, one bit per room. The Room structs are
+// left alone until generate() writes them out with the interiors.
+void MapGenerator::layoutBitboard(std::uint64_t seed)
+{
+    Rng rng = Rng::stream(seed, LayoutStream);
+    Clock::time_point phaseStart = Clock::now();
+
+    m_activeBits.reset(m_roomsX, m_roomsY);
+    m_rightBits.reset(m_roomsX, m_roomsY);
+    m_downBits.reset(m_roomsX, m_roomsY);
+    m_reachedBits.reset(m_roomsX, m_roomsY);
+    m_frontierBits.reset(m_roomsX, m_roomsY);
+    m_nextBits.reset(m_roomsX, m_roomsY);
+    m_runBits.reset(m_roomsX, m_roomsY);
+    m_columnKeys.resize(m_roomsX);
+    const int words = m_activeBits.getWordsPerRow();
+    m_phaseTimes.reset = lap(phaseStart);
+
+    const int startX = walkMainShaft(rng, m_roomsX, m_roomsY,
+        [this](int x, int y) { m_activeBits.set(x, y); });
+    const RoomPos startPos{ startX, 0 };
+    m_phaseTimes.mainShaft = lap(phaseStart);
+
+    // side rooms, a word of them per hash
+    for (int y = 0; y < m_roomsY; ++y)
     {
-        for (int xx = 0; xx < m_roomsX; ++xx)
+        std::uint64_t* active = m_activeBits.row(y);
+        for (int w = 0; w < words; ++w)
+            active[w] |= sideRoomBits(seed, w, y) & m_activeBits.wordMask(w);
+    }
+    m_phaseTimes.sideRooms = lap(phaseStart);
+
+    // a room exits right when it and the next room over are both active,
+    // and down when the room below is
+    for (int y = 0; y < m_roomsY; ++y)
+    {
+        const std::uint64_t* active = m_activeBits.row(y);
+        const std::uint64_t* below = y < m_roomsY - 1 ? m_activeBits.row(y + 1) : nullptr;
+        std::uint64_t* right = m_rightBits.row(y);
+        std::uint64_t* down = m_downBits.row(y);
+        for (int w = 0; w < words; ++w)
         {
-            if (m_rooms[yy][xx].active)
-                generateRoomLayout(m_rooms[yy][xx]);
+            const std::uint64_t next = w < words - 1 ? active[w + 1] : 0;
+            right[w] = active[w] & ((active[w] >> 1) | (next << 63));
+            down[w] = below ? active[w] & below[w] : 0;
         }
     }
+
+    // The index gets an entry per run of active rooms in a row, the right
+    // exits join each run, so only down exits are left to join, and only
+    // the first of each stretch of them: the ones after it join the same
+    // two runs.
+    m_indexByRun = true;
+    m_runRanks.resize(static_cast<std::size_t>(words) * m_roomsY);
+    std::uint32_t runs = 0;
+    for (int y = 0; y < m_roomsY; ++y)
+    {
+        const std::uint64_t* active = m_activeBits.row(y);
+        std::uint64_t* starts = m_runBits.row(y);
+        for (int w = 0; w < words; ++w)
+        {
+            const std::uint64_t carry = w > 0 ? active[w - 1] >> 63 : 0;
+            starts[w] = active[w] & ~((active[w] << 1) | carry);
+            m_runRanks[static_cast<std::size_t>(y) * words + w] = runs;
+            runs += BitGrid::countBits(starts[w]);
+        }
+    }
+
+    // every run is one room until told otherwise, the longer ones start
+    // where the room to the right is active too
+    m_connectivity.reset(runs);
+    for (int y = 0; y < m_roomsY; ++y)
+    {
+        const std::uint64_t* starts = m_runBits.row(y);
+        const std::uint64_t* right = m_rightBits.row(y);
+        for (int w = 0; w < words; ++w)
+        {
+            for (std::uint64_t bits = starts[w] & right[w]; bits; bits &= bits - 1)
+            {
+                const RoomPos room{ w * 64 + BitGrid::lowestBit(bits), y };
+                m_connectivity.setSize(componentIndex(room),
+                    static_cast<std::uint32_t>(m_activeBits.runLength(room.x, y)));
+            }
+        }
+        if (y == 0)
+            continue;
+
+        const std::uint64_t* down = m_downBits.row(y - 1);
+        for (int w = 0; w < words; ++w)
+        {
+            const std::uint64_t carry = w > 0 ? down[w - 1] >> 63 : 0;
+            for (std::uint64_t bits = down[w] & ~((down[w] << 1) | carry); bits; bits &= bits - 1)
+            {
+                const RoomPos room{ w * 64 + BitGrid::lowestBit(bits), y - 1 };
+                m_connectivity.unite(componentIndex(room), componentIndex({ room.x, y }));
+            }
+        }
+    }
+    m_connectivity.flatten();
+    m_phaseTimes.exits = lap(phaseStart);
+
+    // Breadth-first from the start room a whole step at a time: the next
+    // frontier is every unreached room an exit away from the current one.
+    // Only the rows around the frontier can change, so each step costs its
+    // height, not the grid's. The last frontier holds the farthest rooms and
+    // its first in row-major order is the one layoutRooms() would pick.
+    m_frontierBits.set(startPos.x, startPos.y);
+    m_reachedBits.set(startPos.x, startPos.y);
+    int top = startPos.y;
+    int bottom = startPos.y;
+    for (;;)
+    {
+        int nextTop = m_roomsY;
+        int nextBottom = -1;
+        const int first = top > 0 ? top - 1 : 0;
+        const int last = bottom < m_roomsY - 1 ? bottom + 1 : m_roomsY - 1;
+        for (int y = first; y <= last; ++y)
+        {
+            const std::uint64_t* frontier = m_frontierBits.row(y);
+            const std::uint64_t* above = y > 0 ? m_frontierBits.row(y - 1) : nullptr;
+            const std::uint64_t* under = y < m_roomsY - 1 ? m_frontierBits.row(y + 1) : nullptr;
+            const std::uint64_t* right = m_rightBits.row(y);
+            const std::uint64_t* downAbove = y > 0 ? m_downBits.row(y - 1) : nullptr;
+            const std::uint64_t* down = m_downBits.row(y);
+            std::uint64_t* reached = m_reachedBits.row(y);
+            std::uint64_t* next = m_nextBits.row(y);
+
+            std::uint64_t grown = 0;
+            for (int w = 0; w < words; ++w)
+            {
+                // in from the left: a frontier room exiting right, moved up a bit
+                std::uint64_t step = (frontier[w] & right[w]) << 1;
+                if (w > 0)
+                    step |= (frontier[w - 1] & right[w - 1]) >> 63;
+                // in from the right: a room exiting right into the frontier
+                std::uint64_t fromRight = frontier[w] >> 1;
+                if (w < words - 1)
+                    fromRight |= frontier[w + 1] << 63;
+                step |= fromRight & right[w];
+                if (above)
+                    step |= above[w] & downAbove[w];
+                if (under)
+                    step |= under[w] & down[w];
+
+                step &= ~reached[w];
+                next[w] = step;
+                reached[w] |= step;
+                grown |= step;
+            }
+            if (grown)
+            {
+                if (nextTop == m_roomsY)
+                    nextTop = y;
+                nextBottom = y;
+            }
+        }
+        if (nextBottom < 0)
+            break;
+
+        // next becomes the frontier, the old frontier's rows are the only
+        // ones left set so clearing them gives an empty next
+        m_frontierBits.clearRows(top, bottom + 1);
+        std::swap(m_frontierBits, m_nextBits);
+        top = nextTop;
+        bottom = nextBottom;
+    }
+
+    RoomPos bossPos = startPos;
+    const std::uint64_t* farthest = m_frontierBits.row(top);
+    for (int w = 0; w < words; ++w)
+    {
+        if (farthest[w])
+        {
+            bossPos = { w * 64 + BitGrid::lowestBit(farthest[w]), top };
+            break;
+        }
+    }
+    m_startPos = startPos;
+    m_bossPos = bossPos;
+    m_phaseTimes.bossSearch = lap(phaseStart);
+
+    // types are rolled as the rooms are written out, see writeRoom()
+    for (int x = 0; x < m_roomsX; ++x)
+        m_columnKeys[x] = Rng::columnKey(seed, RoomTypeStream, x);
+    m_phaseTimes.roomTypes = lap(phaseStart);
 }
 
-// generate a 10×10 grid for a single room
-void MapGenerator::generateRoomLayout(Room& room)
+// One room as the planes have it. Run by the interiors pass, so each room
+// is written while it is in cache anyway, and on as many threads.
+void MapGenerator::writeRoom(Room& room, int x, int y) const
 {
-    const int WALL = 1;
-    const int FLOOR = 0;
-    int width = Room::width;
-    int height = Room::height;
+    const int w = x >> 6;
+    const int bit = x & 63;
+    room.active = (m_activeBits.row(y)[w] >> bit) & 1;
+    room.exitRight = (m_rightBits.row(y)[w] >> bit) & 1;
+    room.exitDown = (m_downBits.row(y)[w] >> bit) & 1;
+    room.exitLeft = x > 0 && m_rightBits.test(x - 1, y);
+    room.exitUp = y > 0 && m_downBits.test(x, y - 1);
+
+    if (!room.active)
+    {
+        room.type = Room::RoomType::Empty;
+        room.tiles.clear();
+    }
+    else if (x == m_startPos.x && y == m_startPos.y)
+        room.type = Room::RoomType::Start;
+    else if (x == m_bossPos.x && y == m_bossPos.y)
+        room.type = Room::RoomType::Boss;
+    else
+        room.type = roomTypeFromRoll(Rng::columnStream(m_columnKeys[x], y).nextInt(100));
+}
 
-    room.tiles.resize(height, std::vector<int>(width, FLOOR));
+bool MapGenerator::load(const DungeonView& view)
+{
+    if (!view.isOpen() || view.getRoomWidth() < Room::MIN_SIZE || view.getRoomWidth() > Room::MAX_SIZE
+        || view.getRoomHeight() < Room::MIN_SIZE || view.getRoomHeight() > Room::MAX_SIZE)
+        return false;
 
-    for (int i = 0; i < height; i++)
+    if (view.getRoomsX() != m_roomsX || view.getRoomsY() != m_roomsY)
     {
-        for (int j = 0; j < width; j++)
+        m_roomsX = view.getRoomsX();
+        m_roomsY = view.getRoomsY();
+        m_rooms.assign(m_roomsY, std::vector<Room>(m_roomsX));
+    }
+
+    m_roomWidth = view.getRoomWidth();
+    m_roomHeight = view.getRoomHeight();
+    m_seed = view.getSeed();
+    m_startPos = view.getStartRoom();
+    m_bossPos = view.getBossRoom();
+    m_phaseTimes = PhaseTimes{};
+    for (int y = 0; y < m_roomsY; ++y)
+        for (int x = 0; x < m_roomsX; ++x)
+            view.readRoom(x, y, m_rooms[y][x]);
+
+    // the file has the exits, the index is rebuilt from them
+    m_indexByRun = false;
+    m_connectivity.reset(static_cast<std::size_t>(m_roomsX) * m_roomsY);
+    for (int y = 0; y < m_roomsY; ++y)
+    {
+        for (int x = 0; x < m_roomsX; ++x)
         {
-            if (i == 0 || i == height - 1 || j == 0 || j == width - 1)
-                room.tiles[i][j] = WALL;
-            else
-                room.tiles[i][j] = (rand() % 100 < 20) ? WALL : FLOOR;
+            const Room& room = m_rooms[y][x];
+            if (room.exitRight && x < m_roomsX - 1 && m_rooms[y][x + 1].exitLeft)
+                m_connectivity.unite(roomIndex(x, y), roomIndex(x + 1, y));
+            if (room.exitDown && y < m_roomsY - 1 && m_rooms[y + 1][x].exitUp)
+                m_connectivity.unite(roomIndex(x, y), roomIndex(x, y + 1));
         }
     }
+    m_connectivity.flatten();
+    return true;
+}
+
+std::uint64_t MapGenerator::sideRoomBits(std::uint64_t seed, int word, int y)
+{
+    Rng rng = Rng::stream(seed, SideRoomStream, word, y);
+    return rng.next() & rng.next();
+}
+
+MapGenerator::Room::RoomType MapGenerator::rollRoomType(std::uint64_t seed, int x, int y)
+{
+    return roomTypeFromRoll(Rng::stream(seed, RoomTypeStream, x, y).nextInt(100));
+}
+
+MapGenerator::Room::RoomType MapGenerator::roomTypeFromRoll(int r)
+{
+    if (r < 60)
+        return Room::RoomType::Normal;
+    if (r < 80)
+        return Room::RoomType::Treasure;
+    return Room::RoomType::Trap;
+}
+
+// a width x height grid for a single room, with the doors cut
+void MapGenerator::generateRoomLayout(Room& room, std::uint64_t seed, int x, int y, int width, int height)
+{
+    Rng rng = Rng::stream(seed, InteriorStream, x, y);
+    const std::uint8_t FLOOR = TileGrid::Floor;
+    TileGrid& tiles = room.tiles;
+
+    const bool cave = width != RoomPrefabs::SIZE || height != RoomPrefabs::SIZE;
+    if (cave)
+    {
+        thread_local CaveGenerator caves; // bit planes reused per interior thread
+        caves.generate(tiles, width, height, rng);
+    }
+    else
+    {
+        const int prefab = rng.nextInt(RoomPrefabs::getCount(room.type));
+        RoomPrefabs::stamp(tiles, room.type, prefab, rng.nextInt(RoomPrefabs::TRANSFORMS));
+    }
 
-    int mid = width / 2;
+    int midX = width / 2;
+    int midY = height / 2;
 
     // Up
     if (room.exitUp)
     {
         for (int dx = -1; dx <= 1; ++dx)
         {
-            int j = mid + dx;
+            int j = midX + dx;
             if (j >= 0 && j < width)
-                room.tiles[0][j] = FLOOR, room.tiles[1][j] = FLOOR;
+                tiles.set(j, 0, FLOOR), tiles.set(j, 1, FLOOR);
         }
     }
 
@@ -228,9 +569,9 @@ void MapGenerator::generateRoomLayout(Room& room)
     {
         for (int dx = -1; dx <= 1; ++dx)
         {
-            int j = mid + dx;
+            int j = midX + dx;
             if (j >= 0 && j < width)
-                room.tiles[height - 1][j] = FLOOR, room.tiles[height - 2][j] = FLOOR;
+                tiles.set(j, height - 1, FLOOR), tiles.set(j, height - 2, FLOOR);
         }
     }
 
@@ -239,9 +580,9 @@ void MapGenerator::generateRoomLayout(Room& room)
     {
         for (int dy = -1; dy <= 1; ++dy)
         {
-            int i = mid + dy;
+            int i = midY + dy;
             if (i >= 0 && i < height)
-                room.tiles[i][0] = FLOOR, room.tiles[i][1] = FLOOR;
+                tiles.set(0, i, FLOOR), tiles.set(1, i, FLOOR);
         }
     }
 
@@ -250,90 +591,47 @@ void MapGenerator::generateRoomLayout(Room& room)
     {
         for (int dy = -1; dy <= 1; ++dy)
         {
-            int i = mid + dy;
+            int i = midY + dy;
             if (i >= 0 && i < height)
-                room.tiles[i][width - 1] = FLOOR, room.tiles[i][width - 2] = FLOOR;
+                tiles.set(width - 1, i, FLOOR), tiles.set(width - 2, i, FLOOR);
         }
     }
+
+    // a cave can wall its doors off from each other, a prefab can't (see the
+    // static_asserts in RoomPrefabs.cpp)
+    if (!cave)
+        return;
+    DoorConnector::Door doors[4];
+    int doorCount = 0;
+    if (room.exitUp)    doors[doorCount++] = { midX, 0 };
+    if (room.exitDown)  doors[doorCount++] = { midX, height - 1 };
+    if (room.exitLeft)  doors[doorCount++] = { 0, midY };
+    if (room.exitRight) doors[doorCount++] = { width - 1, midY };
+    thread_local DoorConnector connector;
+    connector.connect(tiles, doors, doorCount);
 }
 
-bool MapGenerator::isPathValid(const sf::Vector2i& start, const sf::Vector2i& goal) const
+bool MapGenerator::isReachable(RoomPos from, RoomPos to) const
 {
-    if (!m_rooms[start.y][start.x].active || !m_rooms[goal.y][goal.x].active)
+    if (!m_rooms[from.y][from.x].active || !m_rooms[to.y][to.x].active)
         return false;
-
-    std::vector<std::vector<bool>> visited(m_roomsY, std::vector<bool>(m_roomsX, false));
-    std::queue<sf::Vector2i> q;
-    q.push(start);
-    visited[start.y][start.x] = true;
-
-    const sf::Vector2i dirs[4] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
-
-    while (!q.empty())
-    {
-        auto cur = q.front();
-        q.pop();
-        if (cur == goal) return true;
-
-        const Room& r = m_rooms[cur.y][cur.x];
-        for (auto d : dirs)
-        {
-            int nx = cur.x + d.x, ny = cur.y + d.y;
-            if (nx < 0 || ny < 0 || nx >= m_roomsX || ny >= m_roomsY)
-                continue;
-            if (!m_rooms[ny][nx].active || visited[ny][nx])
-                continue;
-
-            // check corridor connection
-            if (d.x == 1 && r.exitRight) { visited[ny][nx] = true; q.push({ nx, ny }); }
-            if (d.x == -1 && r.exitLeft) { visited[ny][nx] = true; q.push({ nx, ny }); }
-            if (d.y == 1 && r.exitDown) { visited[ny][nx] = true; q.push({ nx, ny }); }
-            if (d.y == -1 && r.exitUp) { visited[ny][nx] = true; q.push({ nx, ny }); }
-        }
-    }
-    return false;
+    return m_connectivity.connected(componentIndex(from), componentIndex(to));
 }
 
-//draw rooms
-void MapGenerator::render(sf::RenderWindow& window)
+int MapGenerator::getComponentSize(RoomPos room) const
 {
-    for (int y = 0; y < m_roomsY; ++y)
-    {
-        for (int x = 0; x < m_roomsX; ++x)
-        {
-            Room& room = m_rooms[y][x];
-            float roomX = x * (m_roomSize + m_gap);
-            float roomY = y * (m_roomSize + m_gap);
-
-            // draw the room block
-            if (room.active)
-                m_roomShape.setFillColor(room.color);
-            else
-                m_roomShape.setFillColor(sf::Color(30, 30, 30));
-
-            m_roomShape.setPosition(roomX, roomY);
-            window.draw(m_roomShape);
-
-            // draw connecting corridors that fill the gap exactly
-            if (room.active)
-            {
-                if (room.exitRight)
-                {
-                    sf::RectangleShape cor(sf::Vector2f((float)m_gap, m_roomSize / 3.f));
-                    cor.setPosition(roomX + m_roomSize, roomY + m_roomSize / 3.f);
-                    cor.setFillColor(sf::Color(110, 110, 110));
-                    window.draw(cor);
-                }
-
-                if (room.exitDown)
-                {
-                    sf::RectangleShape cor(sf::Vector2f(m_roomSize / 3.f, (float)m_gap));
-                    cor.setPosition(roomX + m_roomSize / 3.f, roomY + m_roomSize);
-                    cor.setFillColor(sf::Color(110, 110, 110));
-                    window.draw(cor);
-                }
-            }
-        }
-    }
+    if (!m_rooms[room.y][room.x].active)
+        return 1;
+    return static_cast<int>(m_connectivity.componentSize(componentIndex(room)));
 }
 
+std::uint32_t MapGenerator::componentIndex(RoomPos room) const
+{
+    if (!m_indexByRun)
+        return roomIndex(room.x, room.y);
+    // starts up to and including the room's bit, the last of them is its run
+    const int w = room.x >> 6;
+    const std::uint64_t upTo = ~std::uint64_t(0) >> (63 - (room.x & 63));
+    return m_runRanks[static_cast<std::size_t>(room.y) * m_activeBits.getWordsPerRow() + w]
+        + BitGrid::countBits(m_runBits.row(room.y)[w] & upTo) - 1;
+}
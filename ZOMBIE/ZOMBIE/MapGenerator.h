@@ -1,11 +1,30 @@
 #pragma once
-#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
 #include <vector>
+#include "BitGrid.h"
+#include "DisjointSet.h"
+#include "TileGrid.h"
+#include "Random.h"
+#include "ThreadPool.h"
 
+class DungeonView;
+
+// Pure dungeon generation, no graphics dependency.
+// Drawing lives on the game side (see Game / TileMap).
 class MapGenerator
 {
 public:
 
+    struct RoomPos
+    {
+        int x = 0;
+        int y = 0;
+
+        bool operator==(const RoomPos& other) const { return x == other.x && y == other.y; }
+        bool operator!=(const RoomPos& other) const { return !(*this == other); }
+    };
+
     struct Room
     {
         enum class RoomType { Empty, Normal, Treasure, Trap, Boss, Start };
@@ -14,38 +33,151 @@ public:
         //int type = 0;
         RoomType type = RoomType::Empty;
 
-        sf::Color color = sf::Color(50, 50, 50);
         bool exitUp = false, exitDown = false, exitLeft = false, exitRight = false;
 
-        //interior map data
-        static const int width = 10;
-        static const int height = 10;
-        std::vector<std::vector<int>> tiles; // 0 = floor, 1 = wall
+        //interior map data, MapGenerator::getRoomWidth() x getRoomHeight() tiles
+        static const int DEFAULT_SIZE = 10; // the prefab size
+        static const int MIN_SIZE = 8;
+        static const int MAX_SIZE = 512;
+        TileGrid tiles;
+
+        // back to a default room, keeping the tile buffer for reuse
+        void reset()
+        {
+            active = false;
+            type = RoomType::Empty;
+            exitUp = exitDown = exitLeft = exitRight = false;
+            tiles.clear();
+        }
     };
 
-    MapGenerator(int roomsX, int roomsY, int roomSize);
+    // How generate() lays out the room grid. Both give the same dungeon for
+    // the same seed. Rooms walks the Room structs in every pass; Bitboard
+    // keeps activity and exits as bit planes, finds exits with shifted ANDs
+    // and the boss room by growing the start room's region a step at a
+    // time, and only touches each struct once, as its interior is built.
+    // Bitboard wins from a few hundred rooms a side, see the bitboard bench.
+    enum class Backend { Rooms, Bitboard };
+
+    // wall-clock time of each generate() pass, in milliseconds.
+    // With the Bitboard backend interiors includes writing out the rooms.
+    struct PhaseTimes
+    {
+        double reset = 0.0;
+        double mainShaft = 0.0;
+        double sideRooms = 0.0;
+        double exits = 0.0;
+        double bossSearch = 0.0;
+        double roomTypes = 0.0;
+        double interiors = 0.0;
+
+        double total() const
+        {
+            return reset + mainShaft + sideRooms + exits + bossSearch + roomTypes + interiors;
+        }
+    };
+
+    // room sizes are clamped to Room::MIN_SIZE..MAX_SIZE
+    MapGenerator(int roomsX, int roomsY, int roomWidth = Room::DEFAULT_SIZE, int roomHeight = Room::DEFAULT_SIZE);
     void generate();
-    void render(sf::RenderWindow& window);
-    struct Room;
+    // same seed always gives the same dungeon
+    void generate(std::uint64_t seed);
+    std::uint64_t getSeed() const { return m_seed; }
+    // takes the dungeon from a saved file, room size and all, unpacking
+    // every room and reusing the room buffers when the grid size matches;
+    // false (map unchanged) when its rooms are outside Room::MIN_SIZE..MAX_SIZE.
+    // The game plays saved files through SavedDungeon instead, a room at a time.
+    bool load(const DungeonView& view);
+
+    // threads used for room interiors, 1 = serial, 0 = all cores.
+    // Output is identical whatever the count.
+    void setThreadCount(unsigned count);
+    unsigned getThreadCount() const { return m_pool ? m_pool->getThreadCount() : 1; }
+    void setBackend(Backend backend) { m_backend = backend; }
+    Backend getBackend() const { return m_backend; }
+    // clamped like the constructor's, used from the next generate()
+    void setRoomSize(int width, int height);
+
     const Room& getRoom(int x, int y) const;
+    int getRoomsX() const { return m_roomsX; }
+    int getRoomsY() const { return m_roomsY; }
+    int getRoomWidth() const { return m_roomWidth; } // tiles
+    int getRoomHeight() const { return m_roomHeight; }
+    RoomPos getStartRoom() const { return m_startPos; }
+    RoomPos getBossRoom() const { return m_bossPos; }
+    const PhaseTimes& getPhaseTimes() const { return m_phaseTimes; }
 
-    const sf::Texture& getWallTexture() const { return m_wallTexture; }
-    const sf::Texture& getFloorTexture() const { return m_floorTexture; }
+    // Rooms joined through matching exits, from the index kept by generate()
+    // and load(). Constant time, no allocation, fine from any thread.
+    bool isReachable(RoomPos from, RoomPos to) const;
+    // rooms reachable from room, itself included; 1 for an inactive room
+    int getComponentSize(RoomPos room) const;
+
+    // Fills room.tiles from its own (seed, x, y) stream, with a door cut for
+    // each exit: a prefab for the room's type (see RoomPrefabs) turned at
+    // random when the room is the prefab size, otherwise a cave (see
+    // CaveGenerator, with its doors joined by DoorConnector). Pure, so other
+    // generators (and other threads) can build rooms the same way.
+    static void generateRoomLayout(Room& room, std::uint64_t seed, int x, int y,
+        int width = Room::DEFAULT_SIZE, int height = Room::DEFAULT_SIZE);
+    // Normal / Treasure / Trap roll for a room that is neither start nor boss
+    static Room::RoomType rollRoomType(std::uint64_t seed, int x, int y);
 
 private:
 
     int m_roomsX;
     int m_roomsY;
-    int m_roomSize;
-    int m_gap = 5; // spacing between rooms
+    int m_roomWidth;
+    int m_roomHeight;
+    std::uint64_t m_seed = 0;
+    RoomPos m_startPos;
+    RoomPos m_bossPos;
+    PhaseTimes m_phaseTimes;
 
-    sf::Texture m_wallTexture;
-    sf::Texture m_floorTexture;
+    // salts so each use of the seed gets its own stream
+    enum Stream : std::uint64_t { LayoutStream = 1, SideRoomStream, RoomTypeStream, InteriorStream };
 
-    bool isPathValid(const sf::Vector2i& start, const sf::Vector2i& goal) const;
+    // the layout passes, everything but the interiors
+    void layoutRooms(std::uint64_t seed);
+    void layoutBitboard(std::uint64_t seed);
+    void writeRoom(Room& room, int x, int y) const;
+    static Room::RoomType roomTypeFromRoll(int roll);
+    // Side rooms of row y, columns word * 64 on, a bit each. Both backends
+    // hash a whole word at once: two draws ANDed, so a bit is set one time
+    // in four.
+    static std::uint64_t sideRoomBits(std::uint64_t seed, int word, int y);
+    // an active room's entry in m_connectivity
+    std::uint32_t componentIndex(RoomPos room) const;
+
+    std::uint32_t roomIndex(int x, int y) const
+    {
+        return static_cast<std::uint32_t>(y) * m_roomsX + x;
+    }
 
     std::vector<std::vector<Room>> m_rooms;
-    sf::RectangleShape m_roomShape;
+    DisjointSet m_connectivity; // over roomIndex(), or the runs when m_indexByRun
+
+    // boss search scratch, kept so regenerating doesn't allocate
+    std::vector<int> m_distance;
+    std::vector<std::uint32_t> m_queue;
+
+    // Bitboard backend planes, exitLeft / exitUp are the right / down planes
+    // shifted by one room
+    Backend m_backend = Backend::Rooms;
+    BitGrid m_activeBits;
+    BitGrid m_rightBits;
+    BitGrid m_downBits;
+    BitGrid m_reachedBits; // boss search: visited rooms
+    BitGrid m_frontierBits; // and the rooms of the current and next step
+    BitGrid m_nextBits;
+    std::vector<std::uint64_t> m_columnKeys; // Rng::columnKey() per column
+
+    // Bitboard connectivity: an index entry per horizontal run of active
+    // rooms, which its right exits join already. A room's run is the count
+    // of run starts up to it, from the word's rank and a popcount.
+    bool m_indexByRun = false;
+    BitGrid m_runBits; // first room of each run
+    std::vector<std::uint32_t> m_runRanks; // per word of m_runBits, runs before it
 
-    void generateRoomLayout(Room& room);
+    std::unique_ptr<ThreadPool> m_pool;
 };
@@ -1,27 +1,32 @@
 #include "Player.h"
-#include <iostream>
+#include "Log.h"
 
 Player::Player()
 {
-	if (!m_texture.loadFromFile("ASSETS\\IMAGES\\walk.png"))
-	{
-		std::cout << "Failed to load player texture\n";
-	}
-	m_sprite.setTexture(m_texture);
 	m_sprite.setTextureRect(sf::IntRect(0, 0, m_frameSize.x, m_frameSize.y));
 	m_sprite.setPosition(400.f, 400.f);
 	m_sprite.setScale(2,2);
 
 }
 
-void Player::hadnleInput()
+// the sprite keeps its size without one, so a headless game can skip this
+bool Player::loadTexture(const std::string& path)
+{
+	m_texture = ResourceCache::instance().getTexture(path);
+	if (!m_texture)
+		return false;
+	m_sprite.setTexture(*m_texture);
+	return true;
+}
+
+void Player::hadnleInput(const InputFrame& input)
 {
 	 m_velocity = { 0.f, 0.f };
 
-    bool up = sf::Keyboard::isKeyPressed(sf::Keyboard::W);
-    bool down = sf::Keyboard::isKeyPressed(sf::Keyboard::S);
-    bool left = sf::Keyboard::isKeyPressed(sf::Keyboard::A);
-    bool right = sf::Keyboard::isKeyPressed(sf::Keyboard::D);
+    bool up = input.isDown(InputFrame::Up);
+    bool down = input.isDown(InputFrame::Down);
+    bool left = input.isDown(InputFrame::Left);
+    bool right = input.isDown(InputFrame::Right);
 
     // Build velocity vector
     if (up)    m_velocity.y = -m_speed;
@@ -70,6 +75,13 @@ void Player::render(sf::RenderWindow& window)
 	window.draw(m_sprite);
 }
 
+void Player::render(sf::RenderWindow& window, sf::Vector2f position)
+{
+	sf::RenderStates states;
+	states.transform.translate(position - m_sprite.getPosition());
+	window.draw(m_sprite, states);
+}
+
 void Player::animate(sf::Time dt)
 {
 	m_timeSinceLastFrame += dt.asSeconds();
@@ -1,12 +1,17 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include "InputLog.h"
+#include "ResourceCache.h"
 class Player
 {
 public:
 	Player();
-	void hadnleInput();
+	bool loadTexture(const std::string& path);
+	void hadnleInput(const InputFrame& input);
 	void update(sf::Time dt);
 	void render(sf::RenderWindow& window);
+	// drawn at position instead of where the last update left it
+	void render(sf::RenderWindow& window, sf::Vector2f position);
 	sf::Vector2f getSize() const;
 
 	sf::Vector2f getPosition() const { return m_sprite.getPosition(); }
@@ -16,7 +21,7 @@ public:
 
 private:
 	sf::Sprite m_sprite;
-	sf::Texture m_texture;
+	ResourceCache::TextureHandle m_texture; // shared with every other user of walk.png
 
 	sf::Vector2f m_velocity{ 0.f,0.f };
 	float m_speed{ 200.f };
@@ -0,0 +1,100 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+Profiler::Profiler(int window)
+    : m_window(std::max(1, window))
+{
+    for (auto& samples : m_samples)
+        samples.assign(m_window, 0.f);
+    m_scratch.reserve(m_window);
+    m_frameStart = Clock::now();
+}
+
+void Profiler::beginFrame()
+{
+    m_frameStart = Clock::now();
+    std::fill(std::begin(m_current), std::end(m_current), 0.0);
+}
+
+void Profiler::endFrame()
+{
+    m_current[Frame] = std::chrono::duration<double, std::micro>(Clock::now() - m_frameStart).count();
+
+    const std::size_t slot = m_frameCount % m_window;
+    for (int phase = 0; phase < PHASE_COUNT; ++phase)
+        m_samples[phase][slot] = static_cast<float>(m_current[phase]);
+    ++m_frameCount;
+}
+
+Profiler::Stats Profiler::getStats(Phase phase) const
+{
+    Stats stats;
+    stats.samples = static_cast<int>(std::min<std::uint64_t>(m_frameCount, m_window));
+    if (stats.samples == 0)
+        return stats;
+
+    m_scratch.assign(m_samples[phase].begin(), m_samples[phase].begin() + stats.samples);
+
+    auto percentile = [this, &stats](double p)
+    {
+        std::size_t rank = std::min<std::size_t>(stats.samples - 1,
+            static_cast<std::size_t>(p * stats.samples));
+        std::nth_element(m_scratch.begin(), m_scratch.begin() + rank, m_scratch.end());
+        return static_cast<double>(m_scratch[rank]);
+    };
+
+    stats.p50 = percentile(0.50);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+    stats.max = *std::max_element(m_scratch.begin(), m_scratch.end());
+    return stats;
+}
+
+const char* Profiler::getPhaseName(Phase phase)
+{
+    static const char* const NAMES[PHASE_COUNT] = {
+        "events", "update", "rooms", "player", "zombies", "minimap", "overlay", "display", "frame" };
+    return NAMES[phase];
+}
+
+bool Profiler::writeSummaryCsv(const std::string& path) const
+{
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+
+    std::fprintf(file, "phase,samples,p50_us,p95_us,p99_us,max_us\n");
+    for (int phase = 0; phase < PHASE_COUNT; ++phase)
+    {
+        Stats stats = getStats(static_cast<Phase>(phase));
+        std::fprintf(file, "%s,%d,%.2f,%.2f,%.2f,%.2f\n", getPhaseName(static_cast<Phase>(phase)),
+            stats.samples, stats.p50, stats.p95, stats.p99, stats.max);
+    }
+    std::fclose(file);
+    return true;
+}
+
+bool Profiler::writeFramesCsv(const std::string& path) const
+{
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+
+    std::fprintf(file, "frame");
+    for (int phase = 0; phase < PHASE_COUNT; ++phase)
+        std::fprintf(file, ",%s_us", getPhaseName(static_cast<Phase>(phase)));
+    std::fprintf(file, "\n");
+
+    // oldest frame still in the window first
+    const std::uint64_t count = std::min<std::uint64_t>(m_frameCount, m_window);
+    for (std::uint64_t frame = m_frameCount - count; frame < m_frameCount; ++frame)
+    {
+        std::fprintf(file, "%llu", static_cast<unsigned long long>(frame));
+        for (int phase = 0; phase < PHASE_COUNT; ++phase)
+            std::fprintf(file, ",%.2f", m_samples[phase][frame % m_window]);
+        std::fprintf(file, "\n");
+    }
+    std::fclose(file);
+    return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-phase frame timing. Each phase accumulates its scoped timings over a
+// frame; endFrame() pushes the totals into a rolling window per phase, from
+// which percentiles are computed on demand. Recording is two clock reads
+// and an add per scope, so it can stay on in release builds.
+class Profiler
+{
+public:
+    enum Phase { Events, Update, Rooms, Player, Zombies, MiniMap, Overlay, Display, Frame, PHASE_COUNT };
+
+    struct Stats
+    {
+        double p50 = 0.0; // microseconds
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+        int samples = 0;
+    };
+
+    explicit Profiler(int window = 600);
+
+    void beginFrame();
+    void endFrame();
+    void add(Phase phase, double microseconds) { m_current[phase] += microseconds; }
+
+    Stats getStats(Phase phase) const;
+    static const char* getPhaseName(Phase phase);
+    std::uint64_t getFrameCount() const { return m_frameCount; }
+
+    // per-phase percentile summary, and the raw per-frame window
+    bool writeSummaryCsv(const std::string& path) const;
+    bool writeFramesCsv(const std::string& path) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    int m_window;
+    std::uint64_t m_frameCount = 0;
+    Clock::time_point m_frameStart;
+    double m_current[PHASE_COUNT] = {};
+    std::vector<float> m_samples[PHASE_COUNT]; // ring of m_window frames
+    mutable std::vector<float> m_scratch;
+};
+
+// Adds the lifetime of the scope to one phase of the current frame.
+class ProfileScope
+{
+public:
+    ProfileScope(Profiler& profiler, Profiler::Phase phase)
+        : m_profiler(profiler), m_phase(phase), m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ProfileScope()
+    {
+        m_profiler.add(m_phase, std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - m_start).count());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler& m_profiler;
+    Profiler::Phase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+
+// Small splittable PRNG (SplitMix64). No hidden global state, so any number
+// of independent streams can run side by side on different threads.
+// A stream is keyed by hashing (seed, x, y, salt) into the starting state,
+// which lets each room draw its own sequence regardless of generation order.
+class Rng
+{
+public:
+    explicit Rng(std::uint64_t state) : m_state(state) {}
+
+    static std::uint64_t mix(std::uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    static Rng stream(std::uint64_t seed, std::uint64_t salt, int x = 0, int y = 0)
+    {
+        return columnStream(columnKey(seed, salt, x), y);
+    }
+
+    // stream() in two halves for filling a grid: the column half is the same
+    // for every row, so it can be worked out once per column
+    static std::uint64_t columnKey(std::uint64_t seed, std::uint64_t salt, int x)
+    {
+        return mix(mix(seed ^ mix(salt)) ^ static_cast<std::uint32_t>(x));
+    }
+
+    static Rng columnStream(std::uint64_t columnKey, int y)
+    {
+        return Rng(mix(columnKey ^ (static_cast<std::uint64_t>(static_cast<std::uint32_t>(y)) << 32)));
+    }
+
+    std::uint64_t next()
+    {
+        m_state += 0x9E3779B97F4A7C15ull;
+        return mix(m_state);
+    }
+
+    // uniform-ish in [0, n), multiply-shift instead of modulo
+    int nextInt(int n)
+    {
+        return static_cast<int>(((next() >> 32) * static_cast<std::uint64_t>(n)) >> 32);
+    }
+
+private:
+    std::uint64_t m_state;
+};
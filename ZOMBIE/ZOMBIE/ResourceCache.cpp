@@ -0,0 +1,162 @@
+#include "ResourceCache.h"
+#include "Log.h"
+#include <algorithm>
+
+namespace
+{
+	double msSince(std::chrono::steady_clock::time_point since)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+	}
+}
+
+ResourceCache& ResourceCache::instance()
+{
+	static ResourceCache cache;
+	return cache;
+}
+
+// both slash styles are used around the code, one key per file
+std::string ResourceCache::normalise(const std::string& path)
+{
+	std::string key = path;
+	std::replace(key.begin(), key.end(), '\\', '/');
+	return key;
+}
+
+void ResourceCache::preload(std::initializer_list<const char*> paths)
+{
+	for (const char* path : paths)
+		request(normalise(path));
+}
+
+ResourceCache::Entry& ResourceCache::request(const std::string& key)
+{
+	if (!m_started)
+	{
+		m_start = std::chrono::steady_clock::now();
+		m_started = true;
+	}
+
+	// entries are never erased and live in a unique_ptr, so the worker's
+	// pointer stays valid
+	std::unique_ptr<Entry>& slot = m_entries[key];
+	if (!slot)
+		slot = std::make_unique<Entry>();
+	else if (slot->image.valid())
+		return *slot;
+
+	// new, or trimmed earlier and needed again
+	Entry* entry = slot.get();
+	entry->collected = false;
+	entry->image = std::async(std::launch::async, [key, entry]() -> ImageHandle
+	{
+		auto start = std::chrono::steady_clock::now();
+		auto image = std::make_shared<sf::Image>();
+		bool loaded = image->loadFromFile(key);
+		entry->decodeMs = msSince(start);
+		return loaded ? image : nullptr;
+	}).share();
+	return *entry;
+}
+
+void ResourceCache::collect(Entry& entry)
+{
+	if (entry.collected)
+		return;
+
+	entry.collected = true;
+	m_stats.decodeMs += entry.decodeMs;
+	++m_stats.decoded;
+}
+
+ResourceCache::ImageHandle ResourceCache::waitForImage(const std::string& key, Entry& entry)
+{
+	bool ready = entry.image.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	auto start = std::chrono::steady_clock::now();
+	ImageHandle image = entry.image.get();
+	if (!ready)
+		m_stats.waitMs += msSince(start);
+	collect(entry);
+
+	if (!image && !entry.failed)
+	{
+		// workers can't log, the logger has a single producer
+		LOG_ERROR("Failed to load {}", key.c_str());
+		entry.failed = true;
+	}
+	return image;
+}
+
+ResourceCache::ImageHandle ResourceCache::getImage(const std::string& path)
+{
+	const std::string key = normalise(path);
+	return waitForImage(key, request(key));
+}
+
+ResourceCache::TextureHandle ResourceCache::getTexture(const std::string& path)
+{
+	const std::string key = normalise(path);
+	Entry& entry = request(key);
+	if (TextureHandle texture = entry.texture.lock())
+	{
+		++m_stats.hits;
+		return texture;
+	}
+
+	ImageHandle image = waitForImage(key, entry);
+	if (!image)
+		return nullptr;
+
+	// the only part that needs the GL context
+	auto start = std::chrono::steady_clock::now();
+	auto texture = std::make_shared<sf::Texture>();
+	if (!texture->loadFromImage(*image))
+	{
+		LOG_ERROR("Failed to upload {}", key.c_str());
+		return nullptr;
+	}
+	m_stats.uploadMs += msSince(start);
+	++m_stats.uploaded;
+
+	entry.texture = texture;
+	return texture;
+}
+
+void ResourceCache::trim()
+{
+	for (auto& pair : m_entries)
+	{
+		Entry& entry = *pair.second;
+		if (!entry.image.valid())
+			continue;
+
+		// only images already decoded, never wait here
+		if (entry.image.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			continue;
+
+		collect(entry);
+		if (entry.image.get().use_count() <= 1)
+			entry.image = {};
+	}
+}
+
+ResourceCache::Stats ResourceCache::getStats() const
+{
+	Stats stats = m_stats;
+	for (const auto& pair : m_entries)
+	{
+		if (TextureHandle texture = pair.second->texture.lock())
+		{
+			sf::Vector2u size = texture->getSize();
+			stats.textureBytes += static_cast<std::size_t>(size.x) * size.y * 4;
+			++stats.liveTextures;
+		}
+	}
+	return stats;
+}
+
+double ResourceCache::getElapsedMs() const
+{
+	return m_started ? msSince(m_start) : 0.0;
+}
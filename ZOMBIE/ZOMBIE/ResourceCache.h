@@ -0,0 +1,70 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// One copy of each image/texture file for the whole game. preload() starts
+// decoding files on worker threads straight away, so it can overlap window
+// creation; the first getTexture() of a file waits for its decode if needed
+// and uploads it on the calling (main) thread. Handles are shared pointers:
+// every user of a file shares one texture, which is freed when the last
+// handle goes. Main thread only, the workers never touch the cache itself.
+class ResourceCache
+{
+public:
+	using ImageHandle = std::shared_ptr<const sf::Image>;
+	using TextureHandle = std::shared_ptr<const sf::Texture>;
+
+	struct Stats
+	{
+		int decoded = 0;            // files decoded
+		int uploaded = 0;           // textures created
+		int hits = 0;               // requests served from the cache
+		double decodeMs = 0.0;      // summed over workers
+		double waitMs = 0.0;        // main thread blocked on a decode
+		double uploadMs = 0.0;
+		std::size_t textureBytes = 0; // live textures, 4 bytes a pixel
+		int liveTextures = 0;
+	};
+
+	static ResourceCache& instance();
+
+	void preload(std::initializer_list<const char*> paths);
+
+	// null if the file can't be loaded (logged once)
+	ImageHandle getImage(const std::string& path);
+	TextureHandle getTexture(const std::string& path);
+
+	// forget decoded images nobody holds, once the startup work is done
+	void trim();
+
+	Stats getStats() const;
+	// time since the first preload, for the startup report
+	double getElapsedMs() const;
+
+private:
+	struct Entry
+	{
+		std::shared_future<ImageHandle> image;
+		double decodeMs = 0.0; // filled in by the worker, read after get()
+		std::weak_ptr<const sf::Texture> texture;
+		bool collected = false; // counted in the stats
+		bool failed = false;
+	};
+
+	ResourceCache() = default;
+	static std::string normalise(const std::string& path);
+	Entry& request(const std::string& key);
+	void collect(Entry& entry);
+	ImageHandle waitForImage(const std::string& key, Entry& entry);
+
+	std::unordered_map<std::string, std::unique_ptr<Entry>> m_entries;
+	std::chrono::steady_clock::time_point m_start;
+	bool m_started = false;
+	Stats m_stats;
+};
@@ -0,0 +1,390 @@
+#include "RoomPathfinder.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+    const std::uint32_t NO_PARENT = 0xFFFFFFFFu;
+
+    // room step through each side
+    const int SIDE_X[4] = { 0, 1, 0, -1 };
+    const int SIDE_Y[4] = { -1, 0, 1, 0 };
+}
+
+void RoomPathfinder::getDoorTile(Side side, int& tileX, int& tileY) const
+{
+    // the middle of the 3 tile gap generateRoomLayout carves
+    const int width = m_roomWidth;
+    const int height = m_roomHeight;
+    switch (side)
+    {
+    case Up:    tileX = width / 2; tileY = 0; break;
+    case Right: tileX = width - 1; tileY = height / 2; break;
+    case Down:  tileX = width / 2; tileY = height - 1; break;
+    case Left:  tileX = 0;         tileY = height / 2; break;
+    }
+}
+
+void RoomPathfinder::build(const MapGenerator& map)
+{
+    m_map = &map;
+    m_roomsX = map.getRoomsX();
+    m_roomsY = map.getRoomsY();
+    m_roomWidth = map.getRoomWidth();
+    m_roomHeight = map.getRoomHeight();
+    for (int side = 0; side < 4; ++side)
+        getDoorTile(static_cast<Side>(side), m_doors[side].x, m_doors[side].y);
+    m_wallsRoom = -1;
+    const std::size_t rooms = static_cast<std::size_t>(m_roomsX) * m_roomsY;
+
+    // a door counts only when both rooms are active and both have the exit,
+    // same rule as the reachability search in generate()
+    m_exits.assign(rooms, 0);
+    for (int y = 0; y < m_roomsY; ++y)
+    {
+        for (int x = 0; x < m_roomsX; ++x)
+        {
+            const MapGenerator::Room& room = map.getRoom(x, y);
+            if (!room.active)
+                continue;
+
+            std::uint8_t exits = 0;
+            if (room.exitUp && y > 0 && map.getRoom(x, y - 1).active && map.getRoom(x, y - 1).exitDown)
+                exits |= 1 << Up;
+            if (room.exitRight && x < m_roomsX - 1 && map.getRoom(x + 1, y).active && map.getRoom(x + 1, y).exitLeft)
+                exits |= 1 << Right;
+            if (room.exitDown && y < m_roomsY - 1 && map.getRoom(x, y + 1).active && map.getRoom(x, y + 1).exitUp)
+                exits |= 1 << Down;
+            if (room.exitLeft && x > 0 && map.getRoom(x - 1, y).active && map.getRoom(x - 1, y).exitRight)
+                exits |= 1 << Left;
+            m_exits[y * m_roomsX + x] = exits;
+        }
+    }
+
+    // door to door walking distance inside each room, one BFS per door
+    m_costs.assign(rooms * 16, NO_PATH);
+    for (int y = 0; y < m_roomsY; ++y)
+    {
+        for (int x = 0; x < m_roomsX; ++x)
+        {
+            const int index = y * m_roomsX + x;
+            const std::uint8_t exits = m_exits[index];
+            for (int from = 0; from < 4; ++from)
+            {
+                if (!(exits & (1 << from)))
+                    continue;
+
+                std::uint32_t distance[4];
+                loadWalls(index);
+                doorDistances(exits, m_doors[from].x, m_doors[from].y, distance);
+                for (int to = 0; to < 4; ++to)
+                {
+                    if (to != from)
+                        m_costs[index * 16 + from * 4 + to] = distance[to]; // FAR is NO_PATH
+                }
+            }
+        }
+    }
+
+    // A step raises f by at most twice its cost, and the start's f values are
+    // at most a room's walk and width apart; no walk in a room is longer than
+    // its tiles, so the ring is never lapped.
+    const std::uint32_t span = static_cast<std::uint32_t>(2 * m_roomWidth * m_roomHeight + m_roomWidth + m_roomHeight + 1);
+    std::uint32_t buckets = 1;
+    while (buckets < span)
+        buckets <<= 1;
+    m_bucketMask = buckets - 1;
+    m_bucketHead.resize(buckets);
+    m_bucketStamp.assign(buckets, 0);
+
+    m_goalNode = static_cast<std::uint32_t>(rooms * 4);
+    m_search = 0;
+    m_nodes.assign(rooms * 4 + 1, NodeState{ 0, 0, NO_PARENT });
+}
+
+std::uint32_t RoomPathfinder::getDoorCost(MapGenerator::RoomPos room, Side from, Side to) const
+{
+    return m_costs[roomIndex(room) * 16 + from * 4 + to];
+}
+
+bool RoomPathfinder::findPath(MapGenerator::RoomPos startRoom, int startX, int startY,
+    MapGenerator::RoomPos goalRoom, int goalX, int goalY, std::vector<Waypoint>& path)
+{
+    path.clear();
+    m_nodesExpanded = 0;
+    if (!m_map || !m_map->getRoom(startRoom.x, startRoom.y).active
+        || !m_map->getRoom(goalRoom.x, goalRoom.y).active)
+        return false;
+
+    // the goal room to its doors, and to the start when that's in it too
+    const bool sameRoom = roomIndex(startRoom) == roomIndex(goalRoom);
+    const Tile start{ startX, startY };
+    std::uint32_t goalCost[4];
+    std::uint32_t direct = FAR;
+    loadWalls(roomIndex(goalRoom));
+    doorDistances(m_exits[roomIndex(goalRoom)], goalX, goalY, goalCost,
+        sameRoom ? &start : nullptr, &direct);
+
+    m_goalTileX = goalRoom.x * m_roomWidth + goalX;
+    m_goalTileY = goalRoom.y * m_roomHeight + goalY;
+    return search(startRoom, startX, startY, goalRoom, goalCost, direct, path);
+}
+
+bool RoomPathfinder::findPath(MapGenerator::RoomPos startRoom, int startX, int startY,
+    MapGenerator::RoomPos goalRoom, const FlowField& goalField, std::vector<Waypoint>& path)
+{
+    path.clear();
+    m_nodesExpanded = 0;
+    if (!m_map || goalField.getGoalX() < 0 || goalField.getWidth() != m_roomWidth
+        || goalField.getHeight() != m_roomHeight || !m_map->getRoom(startRoom.x, startRoom.y).active
+        || !m_map->getRoom(goalRoom.x, goalRoom.y).active)
+        return false;
+
+    // FlowField::UNREACHABLE is FAR
+    const std::uint8_t exits = m_exits[roomIndex(goalRoom)];
+    std::uint32_t goalCost[4];
+    for (int side = 0; side < 4; ++side)
+        goalCost[side] = (exits & (1 << side)) ? goalField.getDistance(m_doors[side].x, m_doors[side].y) : FAR;
+    const std::uint32_t direct = roomIndex(startRoom) == roomIndex(goalRoom)
+        ? goalField.getDistance(startX, startY) : FAR;
+
+    m_goalTileX = goalRoom.x * m_roomWidth + goalField.getGoalX();
+    m_goalTileY = goalRoom.y * m_roomHeight + goalField.getGoalY();
+    return search(startRoom, startX, startY, goalRoom, goalCost, direct, path);
+}
+
+bool RoomPathfinder::search(MapGenerator::RoomPos startRoom, int startX, int startY, MapGenerator::RoomPos goalRoom,
+    const std::uint32_t goalCost[4], std::uint32_t direct, std::vector<Waypoint>& path)
+{
+    if (++m_search == 0)
+    {
+        for (NodeState& state : m_nodes)
+            state.stamp = 0;
+        std::fill(m_bucketStamp.begin(), m_bucketStamp.end(), 0);
+        m_search = 1;
+    }
+    m_open.clear();
+    m_openCount = 0;
+    m_bucketF = FAR;
+
+    const int startIndex = roomIndex(startRoom);
+    const int goalIndex = roomIndex(goalRoom);
+
+    // the rest of the tile work, the start room to its doors
+    std::uint32_t startCost[4];
+    loadWalls(startIndex);
+    doorDistances(m_exits[startIndex], startX, startY, startCost);
+    if (direct != FAR)
+        relax(m_goalNode, direct, 0, NO_PARENT);
+
+    for (int side = 0; side < 4; ++side)
+    {
+        if (startCost[side] != FAR)
+            relax(static_cast<std::uint32_t>(startIndex * 4 + side), startCost[side],
+                heuristic(startRoom.x, startRoom.y, side), NO_PARENT);
+    }
+
+    while (m_openCount > 0)
+    {
+        const std::uint32_t bucket = m_bucketF & m_bucketMask;
+        if (m_bucketStamp[bucket] != m_search || m_bucketHead[bucket] == NO_PARENT)
+        {
+            ++m_bucketF;
+            continue;
+        }
+        const OpenNode top = m_open[m_bucketHead[bucket]];
+        m_bucketHead[bucket] = top.next;
+        --m_openCount;
+        if (top.g != m_nodes[top.node].g)
+            continue;
+
+        if (top.node == m_goalNode)
+        {
+            // doors crossed into another room become waypoints, in walking order
+            m_chain.clear();
+            for (std::uint32_t node = m_nodes[m_goalNode].parent; node != NO_PARENT; node = m_nodes[node].parent)
+                m_chain.push_back(node);
+
+            for (std::size_t i = m_chain.size(); i-- > 1;)
+            {
+                const std::uint32_t node = m_chain[i];
+                if (node / 4 == m_chain[i - 1] / 4)
+                    continue;
+
+                Waypoint waypoint;
+                waypoint.room = { static_cast<int>(node / 4) % m_roomsX, static_cast<int>(node / 4) / m_roomsX };
+                waypoint.side = static_cast<Side>(node % 4);
+                getDoorTile(waypoint.side, waypoint.tileX, waypoint.tileY);
+                path.push_back(waypoint);
+            }
+            return true;
+        }
+
+        ++m_nodesExpanded;
+        const int room = static_cast<int>(top.node / 4);
+        const int side = static_cast<int>(top.node % 4);
+        const int roomX = room % m_roomsX;
+        const int roomY = room / m_roomsX;
+
+        if (room == goalIndex && goalCost[side] != FAR)
+            relax(m_goalNode, top.g + goalCost[side], 0, top.node);
+
+        const std::uint32_t* costs = &m_costs[room * 16 + side * 4];
+        for (int to = 0; to < 4; ++to)
+        {
+            if (costs[to] != NO_PATH)
+                relax(static_cast<std::uint32_t>(room * 4 + to), top.g + costs[to],
+                    heuristic(roomX, roomY, to), top.node);
+        }
+
+        if (m_exits[room] & (1 << side))
+        {
+            const int next = room + SIDE_Y[side] * m_roomsX + SIDE_X[side];
+            relax(static_cast<std::uint32_t>(next * 4 + (side ^ 2)), top.g + 1,
+                heuristic(roomX + SIDE_X[side], roomY + SIDE_Y[side], side ^ 2), top.node);
+        }
+    }
+    return false;
+}
+
+// Manhattan distance in whole dungeon tiles, a step never beats it
+std::uint32_t RoomPathfinder::heuristic(int roomX, int roomY, int side) const
+{
+    const Tile& door = m_doors[side];
+    const int tileX = roomX * m_roomWidth + door.x;
+    const int tileY = roomY * m_roomHeight + door.y;
+    return static_cast<std::uint32_t>(std::abs(tileX - m_goalTileX) + std::abs(tileY - m_goalTileY));
+}
+
+void RoomPathfinder::relax(std::uint32_t node, std::uint32_t g, std::uint32_t h, std::uint32_t parent)
+{
+    NodeState& state = m_nodes[node];
+    if (state.stamp == m_search && state.g <= g)
+        return;
+
+    state = { m_search, g, parent };
+
+    const std::uint32_t f = g + h;
+    const std::uint32_t bucket = f & m_bucketMask;
+    if (m_bucketStamp[bucket] != m_search)
+    {
+        m_bucketStamp[bucket] = m_search;
+        m_bucketHead[bucket] = NO_PARENT;
+    }
+    m_open.push_back({ g, node, m_bucketHead[bucket] });
+    m_bucketHead[bucket] = static_cast<std::uint32_t>(m_open.size() - 1);
+    ++m_openCount;
+    m_bucketF = std::min(m_bucketF, f); // only the start's pushes can lower it
+}
+
+bool RoomPathfinder::refine(MapGenerator::RoomPos room, int startX, int startY, int goalX, int goalY,
+    std::vector<Tile>& route)
+{
+    route.clear();
+    if (!m_map || !m_map->getRoom(room.x, room.y).active)
+        return false;
+
+    // distances from the goal as far as the start, then downhill from the start
+    loadWalls(roomIndex(room));
+    const std::uint32_t startIndex = padIndex(startX, startY);
+    tileDistances(goalX, goalY, &startIndex, 1);
+    std::uint32_t distance = tileDistance(startIndex);
+    if (distance == FAR)
+        return false;
+
+    const int stride = m_roomWidth + 2;
+    const int offsets[4] = { -stride, 1, stride, -1 }; // by Side, as SIDE_X / SIDE_Y
+    std::uint32_t index = startIndex;
+    Tile tile{ startX, startY };
+    route.push_back(tile);
+    while (distance > 0)
+    {
+        for (int d = 0; d < 4; ++d)
+        {
+            // the border reads as FAR, so no bounds to check
+            const std::uint32_t next = index + offsets[d];
+            if (tileDistance(next) == distance - 1)
+            {
+                index = next;
+                tile = { tile.x + SIDE_X[d], tile.y + SIDE_Y[d] };
+                break;
+            }
+        }
+        route.push_back(tile);
+        --distance;
+    }
+    return true;
+}
+
+void RoomPathfinder::loadWalls(int room)
+{
+    if (room == m_wallsRoom)
+        return;
+    m_wallsRoom = room;
+
+    const TileGrid& tiles = m_map->getRoom(room % m_roomsX, room / m_roomsX).tiles;
+    const std::size_t stride = static_cast<std::size_t>(m_roomWidth) + 2;
+    m_walls.assign(stride * (m_roomHeight + 2), WALL);
+    for (int y = 0; y < m_roomHeight; ++y)
+    {
+        const std::uint8_t* row = tiles.row(y);
+        std::uint32_t* out = &m_walls[padIndex(0, y)];
+        for (int x = 0; x < m_roomWidth; ++x)
+            out[x] = row[x] == TileGrid::Wall ? WALL : FAR;
+    }
+}
+
+void RoomPathfinder::tileDistances(int fromX, int fromY, const std::uint32_t* targets, int targetCount)
+{
+    m_tileDistance = m_walls; // same size after the first, so no allocation
+    m_tileQueue.resize(m_walls.size());
+
+    const int stride = m_roomWidth + 2;
+    const int offsets[4] = { -stride, 1, stride, -1 };
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    const std::uint32_t from = padIndex(fromX, fromY);
+    m_tileDistance[from] = 0;
+    m_tileQueue[tail++] = from;
+
+    int left = targetCount;
+    while (head < tail)
+    {
+        const std::uint32_t current = m_tileQueue[head++];
+        for (int t = 0; t < targetCount; ++t)
+            left -= targets[t] == current;
+        if (left <= 0)
+            return;
+
+        const std::uint32_t next = m_tileDistance[current] + 1;
+        for (int d = 0; d < 4; ++d)
+        {
+            const std::uint32_t n = current + offsets[d];
+            if (m_tileDistance[n] != FAR)
+                continue;
+
+            m_tileDistance[n] = next;
+            m_tileQueue[tail++] = n;
+        }
+    }
+}
+
+void RoomPathfinder::doorDistances(std::uint8_t exits, int fromX, int fromY, std::uint32_t out[4],
+    const Tile* extraTile, std::uint32_t* extra)
+{
+    std::uint32_t targets[5];
+    int targetCount = 0;
+    for (int side = 0; side < 4; ++side)
+    {
+        if (exits & (1 << side))
+            targets[targetCount++] = padIndex(m_doors[side].x, m_doors[side].y);
+    }
+    if (extraTile)
+        targets[targetCount++] = padIndex(extraTile->x, extraTile->y);
+
+    tileDistances(fromX, fromY, targets, targetCount);
+    for (int side = 0; side < 4; ++side)
+        out[side] = (exits & (1 << side)) ? tileDistance(padIndex(m_doors[side].x, m_doors[side].y)) : FAR;
+    if (extra)
+        *extra = extraTile ? tileDistance(padIndex(extraTile->x, extraTile->y)) : FAR;
+}
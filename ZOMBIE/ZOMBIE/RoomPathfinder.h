@@ -0,0 +1,144 @@
+#pragma once
+#include "FlowField.h"
+#include "MapGenerator.h"
+#include <cstdint>
+#include <vector>
+
+// Two level pathfinding over a generated dungeon. The coarse graph has one
+// node per door (4 per room); doors of neighbouring rooms are joined by a
+// one tile step, and doors of the same room by their walking distance over
+// its tiles, worked out once in build(). A query searches that graph with A*
+// and only touches tiles in the start and goal rooms, so its cost follows
+// the number of rooms on the way rather than the size of the dungeon. Those
+// rooms are searched over a copy with a wall border, like FlowField's, and
+// only until their doors are reached; a goal room that already has a flow
+// field towards the goal needs no search at all. refine() turns the leg
+// inside one room into tiles.
+class RoomPathfinder
+{
+public:
+    enum Side : std::uint8_t { Up = 0, Right = 1, Down = 2, Left = 3 }; // opposite side is side ^ 2
+
+    static constexpr std::uint32_t NO_PATH = 0xFFFFFFFFu;
+
+    struct Tile
+    {
+        int x;
+        int y;
+    };
+
+    // a door on the way, in the room being left
+    struct Waypoint
+    {
+        MapGenerator::RoomPos room;
+        Side side;
+        int tileX; // inside room
+        int tileY;
+    };
+
+    // the map has to outlive the pathfinder and be rebuilt after regenerating
+    void build(const MapGenerator& map);
+    bool isBuilt() const { return m_map != nullptr; }
+
+    // rooms and tiles are in MapGenerator coordinates, the path is the doors
+    // to walk through in order; empty when the goal is reached inside the
+    // start room. False when there is no way there.
+    bool findPath(MapGenerator::RoomPos startRoom, int startX, int startY,
+        MapGenerator::RoomPos goalRoom, int goalX, int goalY, std::vector<Waypoint>& path);
+    // the same with goalRoom's distances read from a field built over its
+    // tiles, towards the goal tile (its getGoalX/Y)
+    bool findPath(MapGenerator::RoomPos startRoom, int startX, int startY,
+        MapGenerator::RoomPos goalRoom, const FlowField& goalField, std::vector<Waypoint>& path);
+
+    // Tiles from start to goal inside one room, both included, one step
+    // apart; a waypoint's tile as the goal gives the walk to that door.
+    // False when the goal can't be reached.
+    bool refine(MapGenerator::RoomPos room, int startX, int startY, int goalX, int goalY,
+        std::vector<Tile>& route);
+
+    // walking distance between two doors of a room, NO_PATH when they don't connect
+    std::uint32_t getDoorCost(MapGenerator::RoomPos room, Side from, Side to) const;
+    int getNodesExpanded() const { return m_nodesExpanded; } // last query
+
+    // of the map given to build()
+    void getDoorTile(Side side, int& tileX, int& tileY) const;
+
+private:
+    struct OpenNode
+    {
+        std::uint32_t g; // stale once the node's g has improved since the push
+        std::uint32_t node;
+        std::uint32_t next; // in m_open, the one pushed before it into its bucket
+    };
+
+    int roomIndex(MapGenerator::RoomPos room) const { return room.y * m_roomsX + room.x; }
+    // padded tile index, the room's tiles start one row and column in
+    std::uint32_t padIndex(int x, int y) const
+    {
+        return static_cast<std::uint32_t>((y + 1) * (m_roomWidth + 2) + x + 1);
+    }
+    // the room's walls into m_walls, unless they are there already
+    void loadWalls(int room);
+    // Breadth-first from a tile over m_walls' room, stopping once every padded
+    // index in targets has its distance; read them back with tileDistance()
+    void tileDistances(int fromX, int fromY, const std::uint32_t* targets, int targetCount);
+    std::uint32_t tileDistance(std::uint32_t padded) const
+    {
+        const std::uint32_t distance = m_tileDistance[padded];
+        return distance == WALL ? FAR : distance;
+    }
+    // from a tile of m_walls' room to each of its open doors, and to one
+    // more tile (FAR for none) when extra isn't null
+    void doorDistances(std::uint8_t exits, int fromX, int fromY, std::uint32_t out[4],
+        const Tile* extraTile = nullptr, std::uint32_t* extra = nullptr);
+    // A* over the doors once the goal room's leg is known
+    bool search(MapGenerator::RoomPos startRoom, int startX, int startY, MapGenerator::RoomPos goalRoom,
+        const std::uint32_t goalCost[4], std::uint32_t direct, std::vector<Waypoint>& path);
+    // the callers know the room's column and row, so no divides per relax
+    std::uint32_t heuristic(int roomX, int roomY, int side) const;
+    void relax(std::uint32_t node, std::uint32_t g, std::uint32_t h, std::uint32_t parent);
+
+    static constexpr std::uint32_t FAR = NO_PATH; // no walk, in tiles as in door costs
+    static constexpr std::uint32_t WALL = FAR - 1;
+
+    const MapGenerator* m_map = nullptr;
+    int m_roomsX = 0;
+    int m_roomsY = 0;
+    int m_roomWidth = 0; // tiles
+    int m_roomHeight = 0;
+    Tile m_doors[4] = {}; // door tile by side
+
+    std::vector<std::uint8_t> m_exits;  // per room, bit per Side, set when the door leads somewhere
+    std::vector<std::uint32_t> m_costs; // per room, 4x4 door to door; big cave walks pass 16 bits
+
+    // search state, stamped instead of cleared so a query doesn't touch every node
+    std::uint32_t m_search = 0;
+    struct NodeState
+    {
+        std::uint32_t stamp; // m_search when g and parent are this query's
+        std::uint32_t g;
+        std::uint32_t parent;
+    };
+    std::vector<NodeState> m_nodes; // a relax touches one of these, not three arrays
+    // The open list is a ring of buckets by f. The heuristic is consistent,
+    // so f never falls below the bucket being taken from nor gets a whole
+    // ring ahead of it, and push and pop are constant time.
+    std::vector<OpenNode> m_open; // every push of the query
+    std::vector<std::uint32_t> m_bucketHead; // last push into each bucket
+    std::vector<std::uint32_t> m_bucketStamp; // m_search when the head is this query's
+    std::uint32_t m_bucketMask = 0;
+    std::uint32_t m_bucketF = 0; // f of the bucket taken from next
+    std::uint32_t m_openCount = 0; // pushed and not taken yet
+    std::uint32_t m_goalNode = 0; // one past the door nodes
+    int m_goalTileX = 0; // whole dungeon tile coordinates
+    int m_goalTileY = 0;
+    int m_nodesExpanded = 0;
+    std::vector<std::uint32_t> m_chain; // path nodes, goal first
+
+    // room BFS scratch, padded with a wall border; a search starts from a
+    // copy of m_walls, so one compare skips both walls and tiles seen
+    int m_wallsRoom = -1;
+    std::vector<std::uint32_t> m_walls; // WALL or FAR
+    std::vector<std::uint32_t> m_tileDistance;
+    std::vector<std::uint32_t> m_tileQueue;
+};
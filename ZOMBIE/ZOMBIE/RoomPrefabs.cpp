@@ -0,0 +1,350 @@
+#include "RoomPrefabs.h"
+#include <array>
+#include <cstddef>
+#include <iterator>
+
+namespace
+{
+    using RoomType = MapGenerator::Room::RoomType;
+
+    using RoomPrefabs::SIZE;
+    const int MID = SIZE / 2; // as in generateRoomLayout
+    static_assert(SIZE <= 16, "a prefab row is 16 bits");
+    static_assert(SIZE == MapGenerator::Room::DEFAULT_SIZE, "the default room is a prefab room");
+    static_assert(TileGrid::Wall == 1 && TileGrid::Floor == 0, "stamp() writes wall bits as tiles");
+
+    // a prefab as drawn, '#' wall and '.' floor
+    struct Art { const char* rows[SIZE]; };
+
+    // as stamped, bit x of rows[y] set for a wall
+    struct Prefab { std::uint16_t rows[SIZE]; };
+
+    struct Tile { int x; int y; };
+
+    // where tile (x, y) of a turned prefab comes from in the drawing
+    constexpr Tile source(int transform, int x, int y)
+    {
+        if (transform & 4)
+        {
+            const int swap = x;
+            x = y;
+            y = swap;
+        }
+        if (transform & 1)
+            x = SIZE - 1 - x;
+        if (transform & 2)
+            y = SIZE - 1 - y;
+        return { x, y };
+    }
+
+    constexpr bool isWall(const Art& art, Tile tile) { return art.rows[tile.y][tile.x] == '#'; }
+
+    // --- compile-time checks, see the static_asserts under the drawings ---
+
+    constexpr bool isWellFormed(const Art& art)
+    {
+        for (int y = 0; y < SIZE; ++y)
+        {
+            for (int x = 0; x < SIZE; ++x)
+                if (art.rows[y][x] != '#' && art.rows[y][x] != '.')
+                    return false;
+            if (art.rows[y][SIZE] != '\0')
+                return false;
+        }
+        return true;
+    }
+
+    constexpr bool hasBorderWalls(const Art& art)
+    {
+        for (int i = 0; i < SIZE; ++i)
+        {
+            if (!isWall(art, { i, 0 }) || !isWall(art, { i, SIZE - 1 })
+                || !isWall(art, { 0, i }) || !isWall(art, { SIZE - 1, i }))
+                return false;
+        }
+        return true;
+    }
+
+    // the tiles just inside the 3 wide gap generateRoomLayout carves for
+    // each exit, whichever way the prefab is turned
+    constexpr bool hasOpenDoorSlots(const Art& art)
+    {
+        for (int transform = 0; transform < RoomPrefabs::TRANSFORMS; ++transform)
+        {
+            for (int d = -1; d <= 1; ++d)
+            {
+                const Tile inside[4] = { { MID + d, 1 }, { MID + d, SIZE - 2 }, { 1, MID + d }, { SIZE - 2, MID + d } };
+                for (Tile tile : inside)
+                    if (isWall(art, source(transform, tile.x, tile.y)))
+                        return false;
+            }
+        }
+        return true;
+    }
+
+    // every floor tile reachable from every other, 4-way
+    constexpr bool isConnected(const Art& art)
+    {
+        bool seen[SIZE * SIZE] = {};
+        int stack[SIZE * SIZE] = {};
+        int top = 0;
+        int floors = 0;
+        for (int i = 0; i < SIZE * SIZE; ++i)
+        {
+            if (!isWall(art, { i % SIZE, i / SIZE }))
+            {
+                if (floors++ == 0)
+                {
+                    seen[i] = true;
+                    stack[top++] = i;
+                }
+            }
+        }
+
+        int reached = 0;
+        while (top > 0)
+        {
+            const int i = stack[--top];
+            ++reached;
+            const Tile next[4] = { { i % SIZE + 1, i / SIZE }, { i % SIZE - 1, i / SIZE },
+                { i % SIZE, i / SIZE + 1 }, { i % SIZE, i / SIZE - 1 } };
+            for (Tile tile : next)
+            {
+                // the border is wall, so neighbours of floor stay in the room
+                const int n = tile.y * SIZE + tile.x;
+                if (!seen[n] && !isWall(art, tile))
+                {
+                    seen[n] = true;
+                    stack[top++] = n;
+                }
+            }
+        }
+        return floors > 0 && reached == floors;
+    }
+
+    constexpr Prefab toPrefab(const Art& art)
+    {
+        Prefab prefab{};
+        for (int y = 0; y < SIZE; ++y)
+            for (int x = 0; x < SIZE; ++x)
+                if (isWall(art, { x, y }))
+                    prefab.rows[y] |= static_cast<std::uint16_t>(1u << x);
+        return prefab;
+    }
+
+    template <std::size_t N>
+    constexpr std::array<Prefab, N> toPrefabs(const Art (&art)[N])
+    {
+        std::array<Prefab, N> prefabs{};
+        for (std::size_t i = 0; i < N; ++i)
+            prefabs[i] = toPrefab(art[i]);
+        return prefabs;
+    }
+
+    // --- the drawings ---
+
+    constexpr Art NORMAL_ART[] = {
+        { { "##########",
+            "#........#",
+            "#.##..##.#",
+            "#.##..##.#",
+            "#........#",
+            "#........#",
+            "#.##..##.#",
+            "#.##..##.#",
+            "#........#",
+            "##########" } },
+        { { "##########",
+            "#........#",
+            "#.#....#.#",
+            "#...##...#",
+            "#..#..#..#",
+            "#........#",
+            "#...##...#",
+            "#.#....#.#",
+            "#........#",
+            "##########" } },
+        { { "##########",
+            "#........#",
+            "#.###....#",
+            "#.#......#",
+            "#........#",
+            "#........#",
+            "#......#.#",
+            "#....###.#",
+            "#........#",
+            "##########" } },
+        { { "##########",
+            "#........#",
+            "#.#...#..#",
+            "#....#...#",
+            "#.#......#",
+            "#......#.#",
+            "#...#....#",
+            "#..#...#.#",
+            "#........#",
+            "##########" } },
+    };
+
+    // a vault in the middle with one way in
+    constexpr Art TREASURE_ART[] = {
+        { { "##########",
+            "#........#",
+            "#........#",
+            "#..####..#",
+            "#..#..#..#",
+            "#..#.....#",
+            "#..####..#",
+            "#........#",
+            "#........#",
+            "##########" } },
+        { { "##########",
+            "#........#",
+            "#.#.##.#.#",
+            "#.#....#.#",
+            "#...##...#",
+            "#...##...#",
+            "#.#....#.#",
+            "#.#.##.#.#",
+            "#........#",
+            "##########" } },
+    };
+
+    // narrow ways through, nowhere to step aside
+    constexpr Art TRAP_ART[] = {
+        { { "##########",
+            "#........#",
+            "#.######.#",
+            "#........#",
+            "#.##..##.#",
+            "#.##..##.#",
+            "#........#",
+            "#.######.#",
+            "#........#",
+            "##########" } },
+        { { "##########",
+            "#........#",
+            "#.#.##.#.#",
+            "#.#.#..#.#",
+            "#...#.##.#",
+            "#.###....#",
+            "#.....#..#",
+            "#.#.#.##.#",
+            "#........#",
+            "##########" } },
+    };
+
+    // open arenas for the horde
+    constexpr Art BOSS_ART[] = {
+        { { "##########",
+            "#........#",
+            "#.#....#.#",
+            "#........#",
+            "#........#",
+            "#........#",
+            "#........#",
+            "#.#....#.#",
+            "#........#",
+            "##########" } },
+        { { "##########",
+            "#........#",
+            "#.##..##.#",
+            "#........#",
+            "#...##...#",
+            "#...##...#",
+            "#........#",
+            "#.##..##.#",
+            "#........#",
+            "##########" } },
+    };
+
+    // quiet and open, the player spawns in the middle
+    constexpr Art START_ART[] = {
+        { { "##########",
+            "#........#",
+            "#........#",
+            "#..#..#..#",
+            "#........#",
+            "#........#",
+            "#..#..#..#",
+            "#........#",
+            "#........#",
+            "##########" } },
+        { { "##########",
+            "#........#",
+            "#.##..##.#",
+            "#.#....#.#",
+            "#........#",
+            "#........#",
+            "#.#....#.#",
+            "#.##..##.#",
+            "#........#",
+            "##########" } },
+    };
+
+    struct ArtSet { const Art* art; std::size_t count; };
+    constexpr ArtSet ALL_ART[] = {
+        { NORMAL_ART, std::size(NORMAL_ART) }, { TREASURE_ART, std::size(TREASURE_ART) },
+        { TRAP_ART, std::size(TRAP_ART) }, { BOSS_ART, std::size(BOSS_ART) },
+        { START_ART, std::size(START_ART) } };
+
+    constexpr bool allArt(bool (*check)(const Art&))
+    {
+        for (const ArtSet& set : ALL_ART)
+            for (std::size_t i = 0; i < set.count; ++i)
+                if (!check(set.art[i]))
+                    return false;
+        return true;
+    }
+
+    static_assert(allArt(isWellFormed), "prefab rows must be SIZE tiles of '#' or '.'");
+    static_assert(allArt(hasBorderWalls), "prefab border must be all wall");
+    static_assert(allArt(hasOpenDoorSlots), "prefab must be floor inside every door slot, in every orientation");
+    static_assert(allArt(isConnected), "prefab floor must be one connected area");
+
+    constexpr auto NORMAL_PREFABS = toPrefabs(NORMAL_ART);
+    constexpr auto TREASURE_PREFABS = toPrefabs(TREASURE_ART);
+    constexpr auto TRAP_PREFABS = toPrefabs(TRAP_ART);
+    constexpr auto BOSS_PREFABS = toPrefabs(BOSS_ART);
+    constexpr auto START_PREFABS = toPrefabs(START_ART);
+
+    struct Library { const Prefab* prefabs; int count; };
+
+    template <std::size_t N>
+    constexpr Library library(const std::array<Prefab, N>& prefabs)
+    {
+        return { prefabs.data(), static_cast<int>(N) };
+    }
+
+    Library libraryFor(RoomType type)
+    {
+        switch (type)
+        {
+        case RoomType::Treasure: return library(TREASURE_PREFABS);
+        case RoomType::Trap: return library(TRAP_PREFABS);
+        case RoomType::Boss: return library(BOSS_PREFABS);
+        case RoomType::Start: return library(START_PREFABS);
+        default: return library(NORMAL_PREFABS);
+        }
+    }
+}
+
+int RoomPrefabs::getCount(RoomType type)
+{
+    return libraryFor(type).count;
+}
+
+void RoomPrefabs::stamp(TileGrid& tiles, RoomType type, int index, int transform)
+{
+    const Prefab& prefab = libraryFor(type).prefabs[index];
+    tiles.resize(SIZE, SIZE);
+    for (int y = 0; y < SIZE; ++y)
+    {
+        std::uint8_t* row = tiles.row(y);
+        for (int x = 0; x < SIZE; ++x)
+        {
+            const Tile from = source(transform, x, y);
+            row[x] = static_cast<std::uint8_t>((prefab.rows[from.y] >> from.x) & 1);
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "MapGenerator.h"
+#include "TileGrid.h"
+
+// Hand-made interiors for each room type, drawn in RoomPrefabs.cpp and
+// checked there at compile time: walls all round the border, the tiles in
+// front of every door slot open in every orientation, and one connected
+// floor so every door reaches every other. Each is stored as one wall bit
+// per tile, so stamping one is a loop over bits with nothing parsed or
+// allocated.
+namespace RoomPrefabs
+{
+    // prefabs are SIZE x SIZE, MapGenerator only uses them for rooms that size
+    static constexpr int SIZE = 10;
+
+    // 4 rotations, each mirrored or not: bit 0 flips x, bit 1 flips y and
+    // bit 2 swaps x and y first
+    static constexpr int TRANSFORMS = 8;
+
+    // prefabs drawn for a type, an active Empty room uses the Normal ones
+    int getCount(MapGenerator::Room::RoomType type);
+
+    // Fills tiles with prefab index of type, turned by transform. Door
+    // gaps in the border are left to the caller, it knows the exits.
+    void stamp(TileGrid& tiles, MapGenerator::Room::RoomType type, int index, int transform);
+}
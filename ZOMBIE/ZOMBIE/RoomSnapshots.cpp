@@ -0,0 +1,106 @@
+#include "RoomSnapshots.h"
+#include <algorithm>
+
+bool RoomSnapshots::create(unsigned width, unsigned height)
+{
+	bool ok = true;
+	for (Slot& slot : m_slots)
+	{
+		ok = slot.texture.create(width, height) && ok;
+		slot.touched = 0;
+	}
+	m_created = ok;
+	m_building = nullptr;
+	return ok;
+}
+
+const RoomSnapshots::Slot* RoomSnapshots::find(std::uint64_t key) const
+{
+	for (const Slot& slot : m_slots)
+		if (slot.touched != 0 && slot.key == key)
+			return &slot;
+	return nullptr;
+}
+
+void RoomSnapshots::touch(std::uint64_t key)
+{
+	for (Slot& slot : m_slots)
+		if (slot.touched != 0 && slot.key == key)
+			slot.touched = ++m_clock;
+}
+
+bool RoomSnapshots::render(std::uint64_t key, const MapGenerator::Room& room, sf::Vector2f tileSize, const TileAtlas& atlas)
+{
+	if (!m_created)
+		return true;
+
+	if (!m_building || m_buildingKey != key)
+	{
+		Slot* slot = &m_slots[0];
+		for (Slot& candidate : m_slots)
+		{
+			if (candidate.touched != 0 && candidate.key == key)
+			{
+				slot = &candidate;
+				break;
+			}
+			if (candidate.touched < slot->touched)
+				slot = &candidate;
+		}
+
+		// not found by contains() or draw() until the last band is in
+		slot->touched = 0;
+		slot->texture.clear(sf::Color::Transparent);
+		m_building = slot;
+		m_buildingKey = key;
+		m_nextRow = 0;
+	}
+
+	const int rows = std::max(1, TILES_PER_STEP / std::max(1, room.tiles.getWidth()));
+	m_tiles.build(room, tileSize, atlas, m_nextRow, rows);
+	m_building->texture.draw(m_tiles);
+	m_nextRow += rows;
+	if (m_nextRow < room.tiles.getHeight())
+		return false;
+
+	m_building->texture.display();
+	m_building->key = key;
+	m_building->touched = ++m_clock;
+	m_building = nullptr;
+	return true;
+}
+
+void RoomSnapshots::draw(sf::RenderTarget& target, std::uint64_t key, const MapGenerator::Room& room,
+	sf::Vector2f offset, sf::Vector2f tileSize, const TileAtlas& atlas)
+{
+	if (const Slot* slot = find(key))
+	{
+		sf::Sprite sprite(slot->texture.getTexture());
+		sprite.setPosition(offset);
+		target.draw(sprite);
+		return;
+	}
+
+	// built once a room, then drawn like it was before the snapshots
+	Fallback* fallback = &m_fallbacks[0];
+	for (Fallback& candidate : m_fallbacks)
+	{
+		if (candidate.drawn != 0 && candidate.key == key)
+		{
+			fallback = &candidate;
+			break;
+		}
+		if (candidate.drawn < fallback->drawn)
+			fallback = &candidate;
+	}
+	if (fallback->drawn == 0 || fallback->key != key)
+	{
+		fallback->tiles.build(room, tileSize, atlas);
+		fallback->key = key;
+	}
+	fallback->drawn = ++m_clock;
+
+	sf::RenderStates states;
+	states.transform.translate(offset);
+	target.draw(fallback->tiles, states);
+}
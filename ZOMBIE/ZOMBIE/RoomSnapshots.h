@@ -0,0 +1,68 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include "MapGenerator.h"
+#include "TileAtlas.h"
+#include "TileMap.h"
+
+// Rooms' static tile layers drawn once into render textures, so a frame
+// draws a room as one textured quad however many tiles it has and a slide
+// between rooms is two. The textures are a fixed pool made up front, so
+// memory stays at POOL_SIZE rooms and nothing is allocated after create():
+// a room that needs a snapshot takes the slot touched longest ago. A big
+// room's snapshot is drawn a band of rows at a time over several calls, so
+// no frame pays for all its tiles. A room without a finished one, or every
+// room when the textures couldn't be made, is drawn from its tiles instead.
+class RoomSnapshots
+{
+public:
+	// the current room and one through each door
+	static const int POOL_SIZE = 5;
+	// drawn into a snapshot per render(), a default room's all fit in one
+	static const int TILES_PER_STEP = 16384;
+
+	// every slot is a room sized (in pixels) render texture; on failure
+	// render() does nothing and draw() always falls back to the tiles
+	bool create(unsigned width, unsigned height);
+
+	bool contains(std::uint64_t key) const { return find(key) != nullptr; }
+	// keeps key's snapshot from being the next one reused
+	void touch(std::uint64_t key);
+	// Draws the next band of room's rows into key's snapshot, which takes the
+	// least recently touched slot; true once it is finished, or can't be
+	// made. Moving on to another key drops the unfinished one.
+	bool render(std::uint64_t key, const MapGenerator::Room& room, sf::Vector2f tileSize, const TileAtlas& atlas);
+	// key's snapshot at offset, or room's tiles while it has none
+	void draw(sf::RenderTarget& target, std::uint64_t key, const MapGenerator::Room& room,
+		sf::Vector2f offset, sf::Vector2f tileSize, const TileAtlas& atlas);
+
+private:
+	struct Slot
+	{
+		sf::RenderTexture texture;
+		std::uint64_t key = 0;
+		std::uint64_t touched = 0; // m_clock when last wanted, 0 = empty
+	};
+
+	// the rooms drawn without a snapshot, the current one and the one slid to
+	struct Fallback
+	{
+		TileMap tiles;
+		std::uint64_t key = 0;
+		std::uint64_t drawn = 0; // m_clock when last drawn, 0 = empty
+	};
+
+	const Slot* find(std::uint64_t key) const;
+
+	std::array<Slot, POOL_SIZE> m_slots;
+	std::array<Fallback, 2> m_fallbacks;
+	std::uint64_t m_clock = 0;
+	bool m_created = false;
+	TileMap m_tiles; // vertices of the band being rendered, reused
+
+	// the unfinished snapshot, empty (touched 0) in its slot until done
+	Slot* m_building = nullptr;
+	std::uint64_t m_buildingKey = 0;
+	int m_nextRow = 0;
+};
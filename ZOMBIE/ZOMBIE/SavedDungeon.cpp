@@ -0,0 +1,67 @@
+#include "SavedDungeon.h"
+#include <algorithm>
+#include <cstdlib>
+
+SavedDungeon::SavedDungeon(int keepRadius)
+    : m_keepRadius(std::max(1, keepRadius))
+{
+}
+
+bool SavedDungeon::open(const char* path)
+{
+    for (Slot& slot : m_slots)
+        slot.used = false;
+    if (!m_view.open(path))
+        return false;
+
+    if (m_view.getRoomWidth() < Room::MIN_SIZE || m_view.getRoomWidth() > Room::MAX_SIZE
+        || m_view.getRoomHeight() < Room::MIN_SIZE || m_view.getRoomHeight() > Room::MAX_SIZE)
+    {
+        m_view.close();
+        return false;
+    }
+    return true;
+}
+
+void SavedDungeon::update(RoomPos center)
+{
+    for (Slot& slot : m_slots)
+    {
+        if (std::max(std::abs(slot.pos.x - center.x), std::abs(slot.pos.y - center.y)) > m_keepRadius)
+            slot.used = false;
+    }
+}
+
+const SavedDungeon::Room& SavedDungeon::getRoom(int x, int y)
+{
+    if (x < 0 || y < 0 || x >= getRoomsX() || y >= getRoomsY())
+        return m_outside;
+
+    Slot* free = nullptr;
+    for (Slot& slot : m_slots)
+    {
+        if (slot.used && slot.pos.x == x && slot.pos.y == y)
+            return *slot.room;
+        if (!slot.used && !free)
+            free = &slot;
+    }
+
+    if (!free)
+    {
+        m_slots.emplace_back();
+        free = &m_slots.back();
+        free->room = std::make_unique<Room>();
+    }
+    free->pos = { x, y };
+    free->used = true;
+    m_view.readRoom(x, y, *free->room);
+    return *free->room;
+}
+
+std::size_t SavedDungeon::getCachedRoomCount() const
+{
+    std::size_t count = 0;
+    for (const Slot& slot : m_slots)
+        count += slot.used;
+    return count;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "DungeonFile.h"
+#include "MapGenerator.h"
+
+// A saved dungeon played straight from its file. The DungeonView stays open
+// for the session and room bytes are read from the mapping; a room's tiles
+// are unpacked only when it is asked for, into a cache that update() trims
+// to the rooms around the player, the way StreamingDungeon keeps its chunks.
+// Dropped rooms' slots and tile buffers go to the next ones, so opening a
+// file costs the same whatever its size and walking it allocates nothing
+// once the cache is warm.
+class SavedDungeon
+{
+public:
+    using Room = MapGenerator::Room;
+    using RoomPos = MapGenerator::RoomPos;
+
+    // keepRadius is in rooms around the player's room
+    explicit SavedDungeon(int keepRadius = 2);
+
+    SavedDungeon(const SavedDungeon&) = delete;
+    SavedDungeon& operator=(const SavedDungeon&) = delete;
+
+    // false when the file can't be read or its rooms are outside
+    // Room::MIN_SIZE..MAX_SIZE
+    bool open(const char* path);
+    // room bytes and packed tiles, for what doesn't need a whole room
+    const DungeonView& getView() const { return m_view; }
+
+    // Once per tick with the player's room: drops the rooms left behind.
+    // References from getRoom() stay valid until the next update().
+    void update(RoomPos center);
+
+    // Any coordinate, outside the grid is an inactive room
+    const Room& getRoom(int x, int y);
+
+    std::uint64_t getSeed() const { return m_view.getSeed(); }
+    int getRoomsX() const { return m_view.getRoomsX(); }
+    int getRoomsY() const { return m_view.getRoomsY(); }
+    int getRoomWidth() const { return m_view.getRoomWidth(); }
+    int getRoomHeight() const { return m_view.getRoomHeight(); }
+    RoomPos getStartRoom() const { return m_view.getStartRoom(); }
+    std::size_t getCachedRoomCount() const;
+
+private:
+    struct Slot
+    {
+        RoomPos pos;
+        bool used = false;
+        std::unique_ptr<Room> room; // stays put while the slots grow
+    };
+
+    DungeonView m_view;
+    int m_keepRadius;
+    std::vector<Slot> m_slots; // a few dozen at most, searched in order
+    Room m_outside;
+};
@@ -0,0 +1,169 @@
+#include "SpatialGrid.h"
+
+void SpatialGrid::configure(float cellWidth, float cellHeight, int cellsX, int cellsY)
+{
+    m_cellWidth = cellWidth;
+    m_cellHeight = cellHeight;
+    m_invCellWidth = 1.f / cellWidth;
+    m_invCellHeight = 1.f / cellHeight;
+    m_cellsX = std::max(1, cellsX);
+    m_cellsY = std::max(1, cellsY);
+    m_cellStart.assign(static_cast<std::size_t>(m_cellsX) * m_cellsY + 1, 0);
+}
+
+int SpatialGrid::cellX(float x) const
+{
+    int c = static_cast<int>(std::floor(x * m_invCellWidth));
+    return std::max(0, std::min(m_cellsX - 1, c));
+}
+
+int SpatialGrid::cellY(float y) const
+{
+    int c = static_cast<int>(std::floor(y * m_invCellHeight));
+    return std::max(0, std::min(m_cellsY - 1, c));
+}
+
+void SpatialGrid::build(const Aabb* boxes, std::size_t count)
+{
+    // sizes only grow, so after the first busy tick nothing reallocates
+    m_cellOf.resize(count);
+    m_sortedIndex.resize(count);
+    m_sortedBoxes.resize(count);
+    std::fill(m_cellStart.begin(), m_cellStart.end(), 0);
+
+    m_maxHalfWidth = 0.f;
+    m_maxHalfHeight = 0.f;
+
+    // count per cell, stored one slot ahead for the prefix sum
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Aabb& box = boxes[i];
+        const float halfWidth = box.width * 0.5f;
+        const float halfHeight = box.height * 0.5f;
+        m_maxHalfWidth = std::max(m_maxHalfWidth, halfWidth);
+        m_maxHalfHeight = std::max(m_maxHalfHeight, halfHeight);
+
+        const std::uint32_t cell = static_cast<std::uint32_t>(
+            cellY(box.top + halfHeight) * m_cellsX + cellX(box.left + halfWidth));
+        m_cellOf[i] = cell;
+        ++m_cellStart[cell + 1];
+    }
+
+    for (std::size_t c = 1; c < m_cellStart.size(); ++c)
+        m_cellStart[c] += m_cellStart[c - 1];
+
+    // scatter, bumping each cell's start as it fills and stepping it back after
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const std::uint32_t slot = m_cellStart[m_cellOf[i]]++;
+        m_sortedIndex[slot] = static_cast<std::uint32_t>(i);
+        m_sortedBoxes[slot] = boxes[i];
+    }
+    for (std::size_t c = m_cellStart.size() - 1; c > 0; --c)
+        m_cellStart[c] = m_cellStart[c - 1];
+    m_cellStart[0] = 0;
+}
+
+void SpatialGrid::queryRadius(float x, float y, float radius, std::vector<std::uint32_t>& out) const
+{
+    out.clear();
+    const float radius2 = radius * radius;
+    const Aabb area{ x - radius, y - radius, radius * 2.f, radius * 2.f };
+
+    if (m_sortedBoxes.empty())
+        return;
+
+    const int x0 = cellX(area.left - m_maxHalfWidth);
+    const int x1 = cellX(area.left + area.width + m_maxHalfWidth);
+    const int y0 = cellY(area.top - m_maxHalfHeight);
+    const int y1 = cellY(area.top + area.height + m_maxHalfHeight);
+
+    for (int cy = y0; cy <= y1; ++cy)
+    {
+        const std::uint32_t begin = m_cellStart[cy * m_cellsX + x0];
+        const std::uint32_t end = m_cellStart[cy * m_cellsX + x1 + 1];
+        for (std::uint32_t i = begin; i < end; ++i)
+        {
+            // closest point of the box to the centre
+            const Aabb& box = m_sortedBoxes[i];
+            const float dx = x - std::max(box.left, std::min(x, box.left + box.width));
+            const float dy = y - std::max(box.top, std::min(y, box.top + box.height));
+            if (dx * dx + dy * dy <= radius2)
+                out.push_back(m_sortedIndex[i]);
+        }
+    }
+}
+
+void SpatialGrid::queryNeighbours(std::uint32_t index, float radius, std::vector<std::uint32_t>& out) const
+{
+    out.clear();
+    if (m_sortedBoxes.empty())
+        return;
+
+    // find the box through its cell rather than keeping a reverse index
+    const std::uint32_t cell = m_cellOf[index];
+    Aabb self{};
+    for (std::uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+    {
+        if (m_sortedIndex[i] == index)
+        {
+            self = m_sortedBoxes[i];
+            break;
+        }
+    }
+
+    const float x = self.left + self.width * 0.5f;
+    const float y = self.top + self.height * 0.5f;
+    const float radius2 = radius * radius;
+
+    // centres only, so the cell range needs no widening
+    const int x0 = cellX(x - radius);
+    const int x1 = cellX(x + radius);
+    const int y0 = cellY(y - radius);
+    const int y1 = cellY(y + radius);
+
+    for (int cy = y0; cy <= y1; ++cy)
+    {
+        const std::uint32_t begin = m_cellStart[cy * m_cellsX + x0];
+        const std::uint32_t end = m_cellStart[cy * m_cellsX + x1 + 1];
+        for (std::uint32_t i = begin; i < end; ++i)
+        {
+            const Aabb& box = m_sortedBoxes[i];
+            const float dx = box.left + box.width * 0.5f - x;
+            const float dy = box.top + box.height * 0.5f - y;
+            if (dx * dx + dy * dy <= radius2 && m_sortedIndex[i] != index)
+                out.push_back(m_sortedIndex[i]);
+        }
+    }
+}
+
+void SpatialGrid::overlapPairs(std::vector<std::pair<std::uint32_t, std::uint32_t>>& out) const
+{
+    out.clear();
+
+    // walk in sorted order and only look at later slots, so each pair is seen
+    // once; a partner's centre is at most the two half sizes away
+    for (std::uint32_t i = 0; i < m_sortedBoxes.size(); ++i)
+    {
+        const Aabb& box = m_sortedBoxes[i];
+        const int x0 = cellX(box.left - m_maxHalfWidth);
+        const int x1 = cellX(box.left + box.width + m_maxHalfWidth);
+        const int y0 = cellY(box.top - m_maxHalfHeight);
+        const int y1 = cellY(box.top + box.height + m_maxHalfHeight);
+
+        for (int cy = y0; cy <= y1; ++cy)
+        {
+            const std::uint32_t begin = std::max(i + 1, m_cellStart[cy * m_cellsX + x0]);
+            const std::uint32_t end = m_cellStart[cy * m_cellsX + x1 + 1];
+            for (std::uint32_t j = begin; j < end; ++j)
+            {
+                if (intersects(box, m_sortedBoxes[j]))
+                {
+                    std::uint32_t a = m_sortedIndex[i];
+                    std::uint32_t b = m_sortedIndex[j];
+                    out.push_back(a < b ? std::make_pair(a, b) : std::make_pair(b, a));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "Collision.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Broadphase over a uniform grid of cells, normally one per room tile.
+// build() buckets every box by the cell of its centre with a counting sort,
+// so the boxes end up stored cell by cell and a query reads a few short
+// contiguous runs. Everything is rebuilt each tick into buffers kept from
+// the last one, so steady state does not allocate. Queries widen their cell
+// range by the largest half size seen, which keeps them exact for boxes
+// bigger than a cell too.
+class SpatialGrid
+{
+public:
+    void configure(float cellWidth, float cellHeight, int cellsX, int cellsY);
+    void build(const Aabb* boxes, std::size_t count);
+
+    std::size_t size() const { return m_sortedBoxes.size(); }
+
+    // calls visit(index) for every box overlapping area, index into build()'s array
+    template <typename Visit>
+    void queryBox(const Aabb& area, Visit&& visit) const;
+
+    // boxes touching the circle
+    void queryRadius(float x, float y, float radius, std::vector<std::uint32_t>& out) const;
+    // boxes whose centre is within radius of box index's centre, itself excluded
+    void queryNeighbours(std::uint32_t index, float radius, std::vector<std::uint32_t>& out) const;
+    // every overlapping pair once, lower index first
+    void overlapPairs(std::vector<std::pair<std::uint32_t, std::uint32_t>>& out) const;
+
+private:
+    int cellX(float x) const;
+    int cellY(float y) const;
+
+    float m_cellWidth = 1.f;
+    float m_cellHeight = 1.f;
+    float m_invCellWidth = 1.f;
+    float m_invCellHeight = 1.f;
+    int m_cellsX = 1;
+    int m_cellsY = 1;
+    float m_maxHalfWidth = 0.f;
+    float m_maxHalfHeight = 0.f;
+
+    std::vector<std::uint32_t> m_cellStart;  // cells + 1 prefix sums
+    std::vector<std::uint32_t> m_cellOf;     // per input box
+    std::vector<std::uint32_t> m_sortedIndex; // input index of each sorted box
+    std::vector<Aabb> m_sortedBoxes;
+};
+
+template <typename Visit>
+void SpatialGrid::queryBox(const Aabb& area, Visit&& visit) const
+{
+    if (m_sortedBoxes.empty())
+        return;
+
+    // a box is filed under its centre, which can sit up to half its size away
+    const int x0 = cellX(area.left - m_maxHalfWidth);
+    const int x1 = cellX(area.left + area.width + m_maxHalfWidth);
+    const int y0 = cellY(area.top - m_maxHalfHeight);
+    const int y1 = cellY(area.top + area.height + m_maxHalfHeight);
+
+    for (int y = y0; y <= y1; ++y)
+    {
+        // cells of a row are adjacent after the sort, so one run per row
+        const std::uint32_t begin = m_cellStart[y * m_cellsX + x0];
+        const std::uint32_t end = m_cellStart[y * m_cellsX + x1 + 1];
+        for (std::uint32_t i = begin; i < end; ++i)
+        {
+            if (intersects(area, m_sortedBoxes[i]))
+                visit(m_sortedIndex[i]);
+        }
+    }
+}
@@ -0,0 +1,277 @@
+#include "StreamingDungeon.h"
+#include <algorithm>
+#include <cstdlib>
+
+StreamingDungeon::StreamingDungeon(std::uint64_t seed, int roomWidth, int roomHeight, int prefetchRadius, int keepRadius)
+    : m_seed(seed),
+    m_roomWidth(std::clamp(roomWidth, static_cast<int>(Room::MIN_SIZE), static_cast<int>(Room::MAX_SIZE))),
+    m_roomHeight(std::clamp(roomHeight, static_cast<int>(Room::MIN_SIZE), static_cast<int>(Room::MAX_SIZE))),
+    m_prefetchRadius(std::max(1, prefetchRadius)),
+    m_keepRadius(std::max(keepRadius, m_prefetchRadius + 1))
+{
+    m_worker = std::thread(&StreamingDungeon::workerLoop, this);
+}
+
+StreamingDungeon::~StreamingDungeon()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_stop = true;
+    }
+    m_jobReady.notify_all();
+    m_worker.join();
+}
+
+std::uint64_t StreamingDungeon::chunkKey(int cx, int cy)
+{
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cy)) << 32)
+        | static_cast<std::uint32_t>(cx);
+}
+
+int StreamingDungeon::floorDiv(int value, int divisor)
+{
+    int q = value / divisor;
+    return (value % divisor < 0) ? q - 1 : q;
+}
+
+void StreamingDungeon::update(RoomPos center)
+{
+    adoptFinished();
+
+    const int minCx = floorDiv(center.x - m_prefetchRadius, CHUNK_W);
+    const int maxCx = floorDiv(center.x + m_prefetchRadius, CHUNK_W);
+    const int minCy = floorDiv(center.y - m_prefetchRadius, CHUNK_H);
+    const int maxCy = floorDiv(center.y + m_prefetchRadius, CHUNK_H);
+
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        for (int cy = minCy; cy <= maxCy; ++cy)
+        {
+            for (int cx = minCx; cx <= maxCx; ++cx)
+            {
+                std::uint64_t key = chunkKey(cx, cy);
+                if (m_chunks.count(key) || m_inFlight.count(key))
+                    continue;
+
+                m_inFlight.insert(key);
+                m_jobs.emplace_back(cx, cy);
+                queued = true;
+            }
+        }
+    }
+    if (queued)
+        m_jobReady.notify_one();
+
+    // drop chunks that are entirely outside the keep radius
+    for (auto it = m_chunks.begin(); it != m_chunks.end();)
+    {
+        const Chunk& chunk = *it->second;
+        int nearX = std::clamp(center.x, chunk.cx * CHUNK_W, chunk.cx * CHUNK_W + CHUNK_W - 1);
+        int nearY = std::clamp(center.y, chunk.cy * CHUNK_H, chunk.cy * CHUNK_H + CHUNK_H - 1);
+        int distance = std::max(std::abs(nearX - center.x), std::abs(nearY - center.y));
+
+        if (distance > m_keepRadius)
+            it = m_chunks.erase(it);
+        else
+            ++it;
+    }
+}
+
+const StreamingDungeon::Room& StreamingDungeon::getRoom(int x, int y)
+{
+    const Chunk& chunk = chunkAt(x, y);
+    return chunk.rooms[(y - chunk.cy * CHUNK_H) * CHUNK_W + (x - chunk.cx * CHUNK_W)];
+}
+
+void StreamingDungeon::markVisited(int x, int y)
+{
+    const Room& room = getRoom(x, y);
+    const int cx = floorDiv(x, CHUNK_W);
+    const int cy = floorDiv(y, CHUNK_H);
+    std::vector<RoomSummary>& summaries = m_summaries[chunkKey(cx, cy)];
+    summaries.resize(CHUNK_W * CHUNK_H);
+
+    RoomSummary& summary = summaries[(y - cy * CHUNK_H) * CHUNK_W + (x - cx * CHUNK_W)];
+    summary.visited = true;
+    summary.active = room.active;
+    summary.exitUp = room.exitUp;
+    summary.exitDown = room.exitDown;
+    summary.exitLeft = room.exitLeft;
+    summary.exitRight = room.exitRight;
+    summary.type = room.type;
+}
+
+StreamingDungeon::RoomSummary StreamingDungeon::getSummary(int x, int y) const
+{
+    const int cx = floorDiv(x, CHUNK_W);
+    const int cy = floorDiv(y, CHUNK_H);
+    auto it = m_summaries.find(chunkKey(cx, cy));
+    if (it == m_summaries.end())
+        return RoomSummary();
+    return it->second[(y - cy * CHUNK_H) * CHUNK_W + (x - cx * CHUNK_W)];
+}
+
+// the chunk holding room (x, y)
+StreamingDungeon::Chunk& StreamingDungeon::chunkAt(int x, int y)
+{
+    const int cx = floorDiv(x, CHUNK_W);
+    const int cy = floorDiv(y, CHUNK_H);
+    const std::uint64_t key = chunkKey(cx, cy);
+
+    auto it = m_chunks.find(key);
+    if (it == m_chunks.end())
+    {
+        adoptFinished();
+        it = m_chunks.find(key);
+    }
+    if (it == m_chunks.end())
+    {
+        // not prefetched yet; a duplicate from the worker is dropped on adopt
+        ++m_syncMisses;
+        it = m_chunks.emplace(key, buildChunk(cx, cy)).first;
+    }
+
+    return *it->second;
+}
+
+void StreamingDungeon::adoptFinished()
+{
+    std::vector<std::unique_ptr<Chunk>> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        finished.swap(m_finished);
+    }
+
+    for (auto& chunk : finished)
+    {
+        std::uint64_t key = chunkKey(chunk->cx, chunk->cy);
+        m_inFlight.erase(key);
+        m_chunks.emplace(key, std::move(chunk)); // no-op if built synchronously
+    }
+}
+
+void StreamingDungeon::workerLoop()
+{
+    for (;;)
+    {
+        std::pair<int, int> job;
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobReady.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if (m_stop)
+                return;
+
+            job = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        std::unique_ptr<Chunk> chunk = buildChunk(job.first, job.second);
+
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_finished.push_back(std::move(chunk));
+    }
+}
+
+// Door position on one border of chunk (cx, cy): its right edge, or its
+// bottom edge if vertical. The neighbour asks with the same arguments.
+int StreamingDungeon::borderDoor(int cx, int cy, bool vertical) const
+{
+    Rng rng = Rng::stream(m_seed, vertical ? DownDoorStream : RightDoorStream, cx, cy);
+    return rng.nextInt(vertical ? CHUNK_W : CHUNK_H);
+}
+
+std::unique_ptr<StreamingDungeon::Chunk> StreamingDungeon::buildChunk(int cx, int cy) const
+{
+    auto chunk = std::make_unique<Chunk>();
+    chunk->cx = cx;
+    chunk->cy = cy;
+    chunk->rooms.resize(CHUNK_W * CHUNK_H);
+
+    auto roomAt = [&chunk](int lx, int ly) -> Room& { return chunk->rooms[ly * CHUNK_W + lx]; };
+
+    for (Room& room : chunk->rooms)
+        room.active = true;
+
+    // random depth-first spanning tree, every room in the chunk is reachable
+    Rng maze = Rng::stream(m_seed, MazeStream, cx, cy);
+    std::vector<bool> visited(CHUNK_W * CHUNK_H, false);
+    std::vector<int> stack;
+    int first = maze.nextInt(CHUNK_W * CHUNK_H);
+    stack.push_back(first);
+    visited[first] = true;
+
+    while (!stack.empty())
+    {
+        int cur = stack.back();
+        int lx = cur % CHUNK_W;
+        int ly = cur / CHUNK_W;
+
+        int options[4];
+        int optionCount = 0;
+        if (ly > 0 && !visited[cur - CHUNK_W])            options[optionCount++] = 0; // up
+        if (ly < CHUNK_H - 1 && !visited[cur + CHUNK_W])  options[optionCount++] = 1; // down
+        if (lx > 0 && !visited[cur - 1])                  options[optionCount++] = 2; // left
+        if (lx < CHUNK_W - 1 && !visited[cur + 1])        options[optionCount++] = 3; // right
+
+        if (optionCount == 0)
+        {
+            stack.pop_back();
+            continue;
+        }
+
+        int dir = options[maze.nextInt(optionCount)];
+        int next = cur;
+        switch (dir)
+        {
+        case 0: next = cur - CHUNK_W; roomAt(lx, ly).exitUp = true;    roomAt(lx, ly - 1).exitDown = true; break;
+        case 1: next = cur + CHUNK_W; roomAt(lx, ly).exitDown = true;  roomAt(lx, ly + 1).exitUp = true;   break;
+        case 2: next = cur - 1;       roomAt(lx, ly).exitLeft = true;  roomAt(lx - 1, ly).exitRight = true; break;
+        case 3: next = cur + 1;       roomAt(lx, ly).exitRight = true; roomAt(lx + 1, ly).exitLeft = true;  break;
+        }
+        visited[next] = true;
+        stack.push_back(next);
+    }
+
+    // a few extra doors so the maze has loops
+    for (int ly = 0; ly < CHUNK_H; ++ly)
+    {
+        for (int lx = 0; lx < CHUNK_W; ++lx)
+        {
+            Rng loops = Rng::stream(m_seed, LoopStream, cx * CHUNK_W + lx, cy * CHUNK_H + ly);
+            if (lx < CHUNK_W - 1 && loops.nextInt(100) < 15)
+                roomAt(lx, ly).exitRight = roomAt(lx + 1, ly).exitLeft = true;
+            if (ly < CHUNK_H - 1 && loops.nextInt(100) < 15)
+                roomAt(lx, ly).exitDown = roomAt(lx, ly + 1).exitUp = true;
+        }
+    }
+
+    // border doors, shared with the neighbouring chunks
+    roomAt(CHUNK_W - 1, borderDoor(cx, cy, false)).exitRight = true;
+    roomAt(0, borderDoor(cx - 1, cy, false)).exitLeft = true;
+    roomAt(borderDoor(cx, cy, true), CHUNK_H - 1).exitDown = true;
+    roomAt(borderDoor(cx, cy - 1, true), 0).exitUp = true;
+
+    // types: start at the origin, one boss per chunk, the rest as MapGenerator rolls them
+    int boss = Rng::stream(m_seed, BossStream, cx, cy).nextInt(CHUNK_W * CHUNK_H);
+    for (int ly = 0; ly < CHUNK_H; ++ly)
+    {
+        for (int lx = 0; lx < CHUNK_W; ++lx)
+        {
+            Room& room = roomAt(lx, ly);
+            int x = cx * CHUNK_W + lx;
+            int y = cy * CHUNK_H + ly;
+
+            if (x == 0 && y == 0)
+                room.type = Room::RoomType::Start;
+            else if (ly * CHUNK_W + lx == boss)
+                room.type = Room::RoomType::Boss;
+            else
+                room.type = MapGenerator::rollRoomType(m_seed, x, y);
+
+            MapGenerator::generateRoomLayout(room, m_seed, x, y, m_roomWidth, m_roomHeight);
+        }
+    }
+
+    return chunk;
+}
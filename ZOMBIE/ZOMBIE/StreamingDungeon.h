@@ -0,0 +1,116 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "MapGenerator.h"
+
+// Unbounded dungeon, generated one chunk of rooms at a time around the player.
+//
+// Every chunk is a pure function of (seed, chunk position): a random spanning
+// tree of rooms inside the chunk, plus one door on each chunk border whose
+// position both neighbours derive from the same edge hash. So exits always
+// agree and an evicted chunk regenerates identically when the player returns.
+//
+// Chunks within the prefetch radius are built on a background thread; only
+// the game thread touches the cache, so getRoom() never takes a lock.
+class StreamingDungeon
+{
+public:
+    using Room = MapGenerator::Room;
+    using RoomPos = MapGenerator::RoomPos;
+
+    static const int CHUNK_W = 8;
+    static const int CHUNK_H = 6;
+
+    // What the minimap shows of a room, a few bytes against the room's
+    // tiles, so it stays after the room's chunk is evicted.
+    struct RoomSummary
+    {
+        bool visited = false;
+        bool active = false;
+        bool exitUp = false;
+        bool exitDown = false;
+        bool exitLeft = false;
+        bool exitRight = false;
+        Room::RoomType type = Room::RoomType::Empty;
+    };
+
+    // Room sizes are in tiles, as for MapGenerator; prefetchRadius /
+    // keepRadius are in rooms around the player's room. A chunk of 512x512
+    // tile rooms is ~12MB, so only the ring just past the prefetch is kept.
+    explicit StreamingDungeon(std::uint64_t seed, int roomWidth = Room::DEFAULT_SIZE,
+        int roomHeight = Room::DEFAULT_SIZE, int prefetchRadius = 2, int keepRadius = 3);
+    ~StreamingDungeon();
+
+    StreamingDungeon(const StreamingDungeon&) = delete;
+    StreamingDungeon& operator=(const StreamingDungeon&) = delete;
+
+    // Once per tick with the player's room: picks up finished chunks, queues
+    // the ones coming into range and evicts the ones left behind.
+    // References from getRoom() stay valid until the next update().
+    void update(RoomPos center);
+
+    // Any coordinate. Builds the chunk on the spot if it was never
+    // prefetched, which only happens if the player outruns the worker.
+    const Room& getRoom(int x, int y);
+
+    // Visiting a room keeps its summary, per chunk, for as long as the
+    // dungeon lives: CHUNK_W * CHUNK_H summaries for each chunk explored,
+    // not its tiles. Unvisited rooms read as a default summary.
+    void markVisited(int x, int y);
+    bool isVisited(int x, int y) const { return getSummary(x, y).visited; }
+    RoomSummary getSummary(int x, int y) const;
+
+    RoomPos getStartRoom() const { return { 0, 0 }; }
+    std::uint64_t getSeed() const { return m_seed; }
+    std::size_t getCachedChunkCount() const { return m_chunks.size(); }
+    int getSyncMisses() const { return m_syncMisses; }
+
+private:
+    struct Chunk
+    {
+        int cx = 0;
+        int cy = 0;
+        std::vector<Room> rooms; // CHUNK_W * CHUNK_H, row-major
+    };
+
+    // salts, kept clear of MapGenerator's streams
+    enum Stream : std::uint64_t { MazeStream = 100, LoopStream, RightDoorStream, DownDoorStream, BossStream };
+
+    static std::uint64_t chunkKey(int cx, int cy);
+    static int floorDiv(int value, int divisor);
+
+    Chunk& chunkAt(int x, int y);
+    std::unique_ptr<Chunk> buildChunk(int cx, int cy) const;
+    int borderDoor(int cx, int cy, bool vertical) const;
+    void adoptFinished();
+    void workerLoop();
+
+    std::uint64_t m_seed;
+    int m_roomWidth;
+    int m_roomHeight;
+    int m_prefetchRadius;
+    int m_keepRadius;
+    int m_syncMisses = 0;
+
+    // game thread only
+    std::unordered_map<std::uint64_t, std::unique_ptr<Chunk>> m_chunks;
+    std::unordered_set<std::uint64_t> m_inFlight;
+    // by chunk key, laid out as Chunk::rooms; only chunks with a visited room
+    std::unordered_map<std::uint64_t, std::vector<RoomSummary>> m_summaries;
+
+    // shared with the worker
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobReady;
+    std::deque<std::pair<int, int>> m_jobs;
+    std::vector<std::unique_ptr<Chunk>> m_finished;
+    bool m_stop = false;
+
+    std::thread m_worker;
+};
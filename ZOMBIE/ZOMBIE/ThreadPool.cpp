@@ -0,0 +1,126 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned i = 0; i < threadCount; ++i)
+        m_queues.push_back(std::make_unique<Queue>());
+
+    for (unsigned i = 1; i < threadCount; ++i)
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+void ThreadPool::parallelFor(int count, int grain, const std::function<void(int, int)>& body)
+{
+    if (count <= 0)
+        return;
+    grain = std::max(1, grain);
+
+    const int chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || m_queues.size() == 1)
+    {
+        body(0, count);
+        return;
+    }
+
+    std::atomic<int> remaining{ chunks };
+
+    // hand each thread a contiguous block of chunks, stealing evens it out
+    const unsigned threads = getThreadCount();
+    for (int c = 0; c < chunks; ++c)
+    {
+        int begin = c * grain;
+        int end = std::min(count, begin + grain);
+        unsigned owner = static_cast<unsigned>(static_cast<long long>(c) * threads / chunks);
+
+        Queue& queue = *m_queues[owner];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.emplace_back([&body, &remaining, begin, end]()
+        {
+            body(begin, end);
+            remaining.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    m_queued.fetch_add(chunks, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+    }
+    m_wake.notify_all();
+
+    // help out until our batch is finished
+    while (remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (!runOne(0))
+            std::this_thread::yield();
+    }
+}
+
+bool ThreadPool::popLocal(unsigned index, Task& task)
+{
+    Queue& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(unsigned thief, Task& task)
+{
+    const unsigned count = getThreadCount();
+    for (unsigned offset = 1; offset < count; ++offset)
+    {
+        Queue& victim = *m_queues[(thief + offset) % count];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty())
+            continue;
+
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::runOne(unsigned index)
+{
+    Task task;
+    if (!popLocal(index, task) && !steal(index, task))
+        return false;
+
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(unsigned index)
+{
+    for (;;)
+    {
+        if (runOne(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait(lock, [this]() { return m_stop || m_queued.load() > 0; });
+        if (m_stop)
+            return;
+    }
+}
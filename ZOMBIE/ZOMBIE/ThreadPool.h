@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool. Every thread (the caller included) has its own task
+// queue; an idle thread takes from the back of its own queue and steals
+// from the front of the others, so uneven chunks balance themselves.
+class ThreadPool
+{
+public:
+    // threadCount includes the calling thread, 0 = hardware concurrency
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(m_queues.size()); }
+
+    // Runs body(begin, end) over [0, count) in chunks of `grain` and blocks
+    // until every chunk is done. The calling thread works too.
+    void parallelFor(int count, int grain, const std::function<void(int, int)>& body);
+
+private:
+    using Task = std::function<void()>;
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool popLocal(unsigned index, Task& task);
+    bool steal(unsigned thief, Task& task);
+    bool runOne(unsigned index);
+    void workerLoop(unsigned index);
+
+    std::vector<std::unique_ptr<Queue>> m_queues; // [0] belongs to the caller
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<int> m_queued{ 0 };
+    bool m_stop = false;
+};
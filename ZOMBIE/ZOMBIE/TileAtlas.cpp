@@ -0,0 +1,91 @@
+#include "TileAtlas.h"
+#include "Log.h"
+#include "ResourceCache.h"
+#include "TileGrid.h"
+
+namespace
+{
+	// missing art falls back to the old flat colours / no overlay
+	bool loadTile(sf::Image& image, const char* path, sf::Color fallback)
+	{
+		// decoded off the main thread by the cache, normally ready by now
+		if (ResourceCache::ImageHandle decoded = ResourceCache::instance().getImage(path))
+		{
+			image = *decoded;
+			return true;
+		}
+
+		image.create(TileAtlas::TILE_SIZE, TileAtlas::TILE_SIZE, fallback);
+		return false;
+	}
+
+	// copy a TILE_SIZE square of src into the atlas slot, blending if asked
+	void stamp(sf::Image& atlas, const sf::Image& src, sf::Vector2u slot, bool blend)
+	{
+		atlas.copy(src, slot.x, slot.y,
+			sf::IntRect(0, 0, TileAtlas::TILE_SIZE, TileAtlas::TILE_SIZE), blend);
+	}
+}
+
+void TileAtlas::build()
+{
+	sf::Image floor;
+	sf::Image wall;
+	sf::Image face;
+	sf::Image sideFace;
+	sf::Image edgeForEast;
+	sf::Image edgeForWest;
+	sf::Image edgeForNorth;
+
+	loadTile(floor, "ASSETS/IMAGES/floor.png", sf::Color(200, 200, 200));
+	loadTile(wall, "ASSETS/IMAGES/wall.png", sf::Color(40, 40, 40));
+	bool hasFace = loadTile(face, "ASSETS/IMAGES/wall_centre.png", sf::Color(40, 40, 40));
+	bool hasSideFace = loadTile(sideFace, "ASSETS/IMAGES/right_wall.png", sf::Color(40, 40, 40));
+	bool hasEast = loadTile(edgeForEast, "ASSETS/IMAGES/wall_left.png", sf::Color::Transparent);
+	bool hasWest = loadTile(edgeForWest, "ASSETS/IMAGES/wall_right.png", sf::Color::Transparent);
+	bool hasNorth = loadTile(edgeForNorth, "ASSETS/IMAGES/wall_bottom.png", sf::Color::Transparent);
+
+	// 17 slots in a 5x4 grid
+	const unsigned columns = 5;
+	const unsigned rows = (MASK_COUNT + 1 + columns - 1) / columns;
+	sf::Image atlas;
+	atlas.create(columns * TILE_SIZE, rows * TILE_SIZE, sf::Color::Transparent);
+
+	auto slotOrigin = [columns](int slot)
+	{
+		return sf::Vector2u((slot % columns) * TILE_SIZE, (slot / columns) * TILE_SIZE);
+	};
+
+	for (int mask = 0; mask < MASK_COUNT; ++mask)
+	{
+		sf::Vector2u origin = slotOrigin(mask);
+
+		// floor to the south means we see the wall's front face, floor to
+		// the east only its side: bricks without the capped top
+		if ((mask & TileGrid::FloorSouth) && hasFace)
+			stamp(atlas, face, origin, false);
+		else if ((mask & TileGrid::FloorEast) && hasSideFace)
+			stamp(atlas, sideFace, origin, false);
+		else
+			stamp(atlas, wall, origin, false);
+
+		// edge strips on the sides that touch floor
+		if ((mask & TileGrid::FloorEast) && hasEast)
+			stamp(atlas, edgeForEast, origin, true);
+		if ((mask & TileGrid::FloorWest) && hasWest)
+			stamp(atlas, edgeForWest, origin, true);
+		if ((mask & TileGrid::FloorNorth) && hasNorth)
+			stamp(atlas, edgeForNorth, origin, true);
+
+		m_rects[mask] = sf::IntRect(origin.x, origin.y, TILE_SIZE, TILE_SIZE);
+	}
+
+	sf::Vector2u floorOrigin = slotOrigin(FLOOR_TILE);
+	stamp(atlas, floor, floorOrigin, false);
+	m_rects[FLOOR_TILE] = sf::IntRect(floorOrigin.x, floorOrigin.y, TILE_SIZE, TILE_SIZE);
+
+	if (!m_texture.loadFromImage(atlas))
+	{
+		LOG_ERROR("Failed to upload tile atlas");
+	}
+}
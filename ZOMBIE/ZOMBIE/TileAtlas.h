@@ -0,0 +1,25 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+
+// All tile art packed into one texture at startup.
+// Wall tiles are pre-composited for every combination of floor neighbours
+// (4-bit mask, see TileGrid::floorMask) so a wall is one lookup, no layering.
+class TileAtlas
+{
+public:
+	static const int TILE_SIZE = 96;
+	static const int MASK_COUNT = 16;
+	static const int FLOOR_TILE = MASK_COUNT; // slot after the 16 wall variants
+
+	void build();
+
+	const sf::Texture& getTexture() const { return m_texture; }
+	const sf::IntRect& getWallRect(std::uint8_t mask) const { return m_rects[mask & (MASK_COUNT - 1)]; }
+	const sf::IntRect& getFloorRect() const { return m_rects[FLOOR_TILE]; }
+
+private:
+	sf::Texture m_texture;
+	std::array<sf::IntRect, MASK_COUNT + 1> m_rects; // atlas slot -> texture rect
+};
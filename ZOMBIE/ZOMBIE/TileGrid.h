@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Contiguous row-major tile storage for a room interior, one byte per tile.
+// clear() keeps the buffer so regenerating a room does not reallocate.
+class TileGrid
+{
+public:
+    enum Tile : std::uint8_t { Floor = 0, Wall = 1 };
+    // bits of floorMask()
+    enum Neighbour : std::uint8_t { FloorNorth = 1, FloorEast = 2, FloorSouth = 4, FloorWest = 8 };
+
+    void resize(int width, int height, std::uint8_t fill = Floor)
+    {
+        m_width = width;
+        m_height = height;
+        m_tiles.assign(static_cast<std::size_t>(width) * height, fill);
+    }
+
+    void clear()
+    {
+        m_width = 0;
+        m_height = 0;
+        m_tiles.clear();
+    }
+
+    bool empty() const { return m_tiles.empty(); }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    std::uint8_t get(int x, int y) const { return m_tiles[index(x, y)]; }
+    void set(int x, int y, std::uint8_t tile) { m_tiles[index(x, y)] = tile; }
+    bool isWall(int x, int y) const { return get(x, y) == Wall; }
+
+    // which of the 4 neighbours are floor, outside the room counts as wall
+    std::uint8_t floorMask(int x, int y) const
+    {
+        std::uint8_t mask = 0;
+        if (y > 0 && !isWall(x, y - 1))              mask |= FloorNorth;
+        if (x < m_width - 1 && !isWall(x + 1, y))    mask |= FloorEast;
+        if (y < m_height - 1 && !isWall(x, y + 1))   mask |= FloorSouth;
+        if (x > 0 && !isWall(x - 1, y))              mask |= FloorWest;
+        return mask;
+    }
+
+    const std::uint8_t* row(int y) const { return m_tiles.data() + index(0, y); }
+    std::uint8_t* row(int y) { return m_tiles.data() + index(0, y); }
+
+private:
+    std::size_t index(int x, int y) const
+    {
+        return static_cast<std::size_t>(y) * m_width + x;
+    }
+
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<std::uint8_t> m_tiles;
+};
@@ -0,0 +1,53 @@
+#include "TileMap.h"
+#include <algorithm>
+
+void TileMap::build(const MapGenerator::Room& room, sf::Vector2f tileSize, const TileAtlas& atlas)
+{
+	build(room, tileSize, atlas, 0, room.tiles.getHeight());
+}
+
+void TileMap::build(const MapGenerator::Room& room, sf::Vector2f tileSize, const TileAtlas& atlas,
+	int firstRow, int rowCount)
+{
+	m_texture = &atlas.getTexture();
+	const TileGrid& tiles = room.tiles;
+	const int width = tiles.getWidth();
+	const int endRow = std::min(firstRow + rowCount, tiles.getHeight());
+	m_vertices.resize(static_cast<std::size_t>(width) * std::max(endRow - firstRow, 0) * 6);
+
+	for (int i = firstRow; i < endRow; ++i)
+	{
+		const std::uint8_t* row = tiles.row(i);
+		for (int j = 0; j < width; ++j)
+		{
+			const sf::IntRect& src = (row[j] == TileGrid::Wall)
+				? atlas.getWallRect(tiles.floorMask(j, i))
+				: atlas.getFloorRect();
+
+			float left = j * tileSize.x;
+			float top = i * tileSize.y;
+			float right = left + tileSize.x;
+			float bottom = top + tileSize.y;
+
+			float u0 = static_cast<float>(src.left);
+			float v0 = static_cast<float>(src.top);
+			float u1 = u0 + src.width;
+			float v1 = v0 + src.height;
+
+			// two triangles per tile
+			sf::Vertex* quad = &m_vertices[(static_cast<std::size_t>(i - firstRow) * width + j) * 6];
+			quad[0] = sf::Vertex({ left, top }, { u0, v0 });
+			quad[1] = sf::Vertex({ right, top }, { u1, v0 });
+			quad[2] = sf::Vertex({ right, bottom }, { u1, v1 });
+			quad[3] = sf::Vertex({ left, top }, { u0, v0 });
+			quad[4] = sf::Vertex({ right, bottom }, { u1, v1 });
+			quad[5] = sf::Vertex({ left, bottom }, { u0, v1 });
+		}
+	}
+}
+
+void TileMap::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	states.texture = m_texture;
+	target.draw(m_vertices, states);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "MapGenerator.h"
+#include "TileAtlas.h"
+
+// Static tile layer for one room, baked into a single vertex array
+// so the whole room is one draw call.
+class TileMap : public sf::Drawable
+{
+public:
+	// walls pick their atlas tile from the floor-neighbour mask, worked out
+	// once here so drawing never branches per tile
+	void build(const MapGenerator::Room& room, sf::Vector2f tileSize, const TileAtlas& atlas);
+	// only rowCount rows from firstRow on, where they are in the room, for
+	// drawing a big room a band at a time
+	void build(const MapGenerator::Room& room, sf::Vector2f tileSize, const TileAtlas& atlas,
+		int firstRow, int rowCount);
+	bool isBuilt() const { return m_texture != nullptr; }
+
+private:
+	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+	sf::VertexArray m_vertices{ sf::Triangles };
+	const sf::Texture* m_texture{ nullptr };
+};
@@ -0,0 +1,82 @@
+#include "ZombiePursuit.h"
+
+namespace
+{
+    // room step through each side, as RoomPathfinder::Side
+    const int SIDE_X[4] = { 0, 1, 0, -1 };
+    const int SIDE_Y[4] = { -1, 0, 1, 0 };
+}
+
+void ZombiePursuit::clear()
+{
+    m_pursuers.clear();
+    m_doors.clear();
+    m_legs.clear();
+}
+
+void ZombiePursuit::add(MapGenerator::RoomPos room, int tileX, int tileY)
+{
+    if (static_cast<int>(m_pursuers.size()) >= MAX_PURSUERS)
+        return;
+
+    Pursuer pursuer;
+    pursuer.room = room;
+    pursuer.tileX = tileX;
+    pursuer.tileY = tileY;
+    m_pursuers.push_back(pursuer);
+}
+
+void ZombiePursuit::retarget(RoomPathfinder& paths, MapGenerator::RoomPos room, const FlowField& field)
+{
+    for (int side = 0; side < 4; ++side)
+        paths.getDoorTile(static_cast<RoomPathfinder::Side>(side), m_doorTiles[side].x, m_doorTiles[side].y);
+
+    // where each one is now is its last door, the way on is planned again
+    m_doors.clear();
+    m_legs.clear();
+    for (std::size_t i = 0; i < m_pursuers.size();)
+    {
+        Pursuer& pursuer = m_pursuers[i];
+        const bool found = paths.findPath(pursuer.room, pursuer.tileX, pursuer.tileY, room, field, m_path)
+            && (m_path.empty() || paths.refine(pursuer.room, pursuer.tileX, pursuer.tileY,
+                m_path[0].tileX, m_path[0].tileY, m_route));
+        if (!found)
+        {
+            m_pursuers[i] = m_pursuers.back();
+            m_pursuers.pop_back();
+            continue;
+        }
+
+        pursuer.walked = 0.f;
+        pursuer.first = static_cast<std::uint32_t>(m_doors.size());
+        pursuer.count = static_cast<std::uint32_t>(m_path.size());
+        pursuer.next = 0;
+        for (std::size_t d = 0; d < m_path.size(); ++d)
+        {
+            // to the first door over its tiles, then door to door; one more
+            // step through each into the next room
+            const std::uint32_t inside = d == 0
+                ? static_cast<std::uint32_t>(m_route.size() - 1)
+                : paths.getDoorCost(m_path[d].room,
+                    static_cast<RoomPathfinder::Side>(m_path[d - 1].side ^ 2), m_path[d].side);
+            m_doors.push_back(m_path[d]);
+            m_legs.push_back(inside + 1);
+        }
+        ++i;
+    }
+}
+
+bool ZombiePursuit::step(Pursuer& pursuer, float tiles)
+{
+    pursuer.walked += tiles;
+    while (pursuer.next < pursuer.count && pursuer.walked >= m_legs[pursuer.first + pursuer.next])
+    {
+        const RoomPathfinder::Waypoint& door = m_doors[pursuer.first + pursuer.next];
+        pursuer.walked -= static_cast<float>(m_legs[pursuer.first + pursuer.next]);
+        pursuer.room = { door.room.x + SIDE_X[door.side], door.room.y + SIDE_Y[door.side] };
+        pursuer.tileX = m_doorTiles[door.side ^ 2].x;
+        pursuer.tileY = m_doorTiles[door.side ^ 2].y;
+        ++pursuer.next;
+    }
+    return pursuer.next == pursuer.count;
+}
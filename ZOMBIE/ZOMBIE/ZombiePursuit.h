@@ -0,0 +1,68 @@
+#pragma once
+#include "RoomPathfinder.h"
+#include <cstdint>
+#include <vector>
+
+// Zombies still chasing when the player leaves their room. They keep
+// following off screen, a door at a time along RoomPathfinder's route to the
+// player's room, and come in through its door once they get there, where
+// the room's ZombieSystem takes them over. Only where they are at the last
+// door they went through is kept, so a pursuer costs no tile work between
+// room changes. Fixed map only, the pathfinder needs the whole room grid.
+class ZombiePursuit
+{
+public:
+    static const int MAX_PURSUERS = 16;
+
+    void clear();
+    std::size_t size() const { return m_pursuers.size(); }
+
+    // a zombie left behind on a tile of room; retarget() before the next
+    // advance() gives it its route
+    void add(MapGenerator::RoomPos room, int tileX, int tileY);
+
+    // the player is now in room, on the goal tile of a field built over it:
+    // routes every pursuer there, dropping the ones that can't reach it
+    void retarget(RoomPathfinder& paths, MapGenerator::RoomPos room, const FlowField& field);
+
+    // Walks every pursuer the given number of tiles. arrive(tileX, tileY)
+    // is called with the door tile of each one that reaches the player's
+    // room, which then leaves the pursuit.
+    template <class Arrive>
+    void advance(float tiles, Arrive arrive)
+    {
+        for (std::size_t i = 0; i < m_pursuers.size();)
+        {
+            if (step(m_pursuers[i], tiles))
+            {
+                arrive(m_pursuers[i].tileX, m_pursuers[i].tileY);
+                m_pursuers[i] = m_pursuers.back();
+                m_pursuers.pop_back();
+            }
+            else
+                ++i;
+        }
+    }
+
+private:
+    struct Pursuer
+    {
+        MapGenerator::RoomPos room;
+        int tileX = 0;
+        int tileY = 0;
+        float walked = 0.f; // tiles since the last door
+        std::uint32_t first = 0; // route in m_doors / m_legs
+        std::uint32_t count = 0;
+        std::uint32_t next = 0;
+    };
+
+    // true once in the player's room
+    bool step(Pursuer& pursuer, float tiles);
+
+    RoomPathfinder::Tile m_doorTiles[4] = {}; // by side, in the room being entered
+    std::vector<Pursuer> m_pursuers;
+    std::vector<RoomPathfinder::Waypoint> m_doors; // every pursuer's route, back to back
+    std::vector<std::uint32_t> m_legs; // tiles to walk through each door
+    std::vector<RoomPathfinder::Waypoint> m_path; // scratch
+    std::vector<RoomPathfinder::Tile> m_route;
+};
@@ -0,0 +1,51 @@
+#include "ZombieRenderer.h"
+
+bool ZombieRenderer::loadTexture(const std::string& path)
+{
+	m_texture = ResourceCache::instance().getTexture(path);
+	return m_texture != nullptr;
+}
+
+void ZombieRenderer::update(const ZombieSystem& zombies, float alpha)
+{
+	const std::size_t count = zombies.size();
+	m_vertices.resize(count * 6);
+
+	const float* xs = zombies.getX();
+	const float* ys = zombies.getY();
+	const float* prevXs = zombies.getPreviousX();
+	const float* prevYs = zombies.getPreviousY();
+	const std::uint8_t* frames = zombies.getFrame();
+	const std::uint8_t* rows = zombies.getRow();
+
+	const float width = ZombieSystem::FRAME_WIDTH * m_scale;
+	const float height = ZombieSystem::FRAME_HEIGHT * m_scale;
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		float left = prevXs[i] + (xs[i] - prevXs[i]) * alpha;
+		float top = prevYs[i] + (ys[i] - prevYs[i]) * alpha;
+		float right = left + width;
+		float bottom = top + height;
+
+		float u0 = static_cast<float>(frames[i] * ZombieSystem::FRAME_WIDTH);
+		float v0 = static_cast<float>(rows[i] * ZombieSystem::FRAME_HEIGHT);
+		float u1 = u0 + ZombieSystem::FRAME_WIDTH;
+		float v1 = v0 + ZombieSystem::FRAME_HEIGHT;
+
+		// two triangles per zombie
+		sf::Vertex* quad = &m_vertices[i * 6];
+		quad[0] = sf::Vertex({ left, top }, m_color, { u0, v0 });
+		quad[1] = sf::Vertex({ right, top }, m_color, { u1, v0 });
+		quad[2] = sf::Vertex({ right, bottom }, m_color, { u1, v1 });
+		quad[3] = sf::Vertex({ left, top }, m_color, { u0, v0 });
+		quad[4] = sf::Vertex({ right, bottom }, m_color, { u1, v1 });
+		quad[5] = sf::Vertex({ left, bottom }, m_color, { u0, v1 });
+	}
+}
+
+void ZombieRenderer::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	states.texture = m_texture.get();
+	target.draw(m_vertices, states);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "ResourceCache.h"
+#include "ZombieSystem.h"
+
+// Draws every zombie from the walk sheet in one vertex array, rebuilt each
+// frame straight from the ZombieSystem arrays. alpha places the zombies
+// between their previous (0) and current (1) tick positions.
+class ZombieRenderer : public sf::Drawable
+{
+public:
+	bool loadTexture(const std::string& path);
+	void update(const ZombieSystem& zombies, float alpha = 1.f);
+
+	void setScale(float scale) { m_scale = scale; }
+	void setColor(sf::Color color) { m_color = color; }
+
+private:
+	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+	ResourceCache::TextureHandle m_texture;
+	sf::VertexArray m_vertices{ sf::Triangles };
+	float m_scale{ 2.f };
+	sf::Color m_color{ 140, 220, 120 }; // player sheet tinted green
+};
@@ -0,0 +1,219 @@
+#include "ZombieSystem.h"
+#include "FlowField.h"
+#include <cmath>
+
+namespace
+{
+    const float FRAME_DURATION = 0.12f;
+
+    // a velocity component counts as a direction past sin(22.5deg) of the speed
+    const float DIRECTION_THRESHOLD = 0.38f;
+
+    // sprite row by [vertical + 1][horizontal + 1] in -1/0/1, same rows as
+    // Player::hadnleInput, 0xFF keeps the current row when standing
+    const std::uint8_t FACING_ROW[3][3] = {
+        { 2, 3, 4 },    // up left, up, up right
+        { 1, 0xFF, 5 }, // left, none, right
+        { 1, 0, 5 } };  // down left, down, down right
+}
+
+void ZombieSystem::reserve(std::size_t count)
+{
+    m_x.reserve(count);
+    m_y.reserve(count);
+    m_prevX.reserve(count);
+    m_prevY.reserve(count);
+    m_vx.reserve(count);
+    m_vy.reserve(count);
+    m_frameTime.reserve(count);
+    m_frame.reserve(count);
+    m_row.reserve(count);
+    m_state.reserve(count);
+}
+
+void ZombieSystem::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_prevX.clear();
+    m_prevY.clear();
+    m_vx.clear();
+    m_vy.clear();
+    m_frameTime.clear();
+    m_frame.clear();
+    m_row.clear();
+    m_state.clear();
+}
+
+std::size_t ZombieSystem::spawn(float x, float y)
+{
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_prevX.push_back(x);
+    m_prevY.push_back(y);
+    m_vx.push_back(0.f);
+    m_vy.push_back(0.f);
+    m_frameTime.push_back(0.f);
+    m_frame.push_back(0);
+    m_row.push_back(0);
+    m_state.push_back(Idle);
+    return m_x.size() - 1;
+}
+
+void ZombieSystem::kill(std::size_t index)
+{
+    const std::size_t last = m_x.size() - 1;
+    m_x[index] = m_x[last];
+    m_y[index] = m_y[last];
+    m_prevX[index] = m_prevX[last];
+    m_prevY[index] = m_prevY[last];
+    m_vx[index] = m_vx[last];
+    m_vy[index] = m_vy[last];
+    m_frameTime[index] = m_frameTime[last];
+    m_frame[index] = m_frame[last];
+    m_row[index] = m_row[last];
+    m_state[index] = m_state[last];
+
+    m_x.pop_back();
+    m_y.pop_back();
+    m_prevX.pop_back();
+    m_prevY.pop_back();
+    m_vx.pop_back();
+    m_vy.pop_back();
+    m_frameTime.pop_back();
+    m_frame.pop_back();
+    m_row.pop_back();
+    m_state.pop_back();
+}
+
+void ZombieSystem::setHitbox(float offsetX, float offsetY, float width, float height)
+{
+    m_hitOffsetX = offsetX;
+    m_hitOffsetY = offsetY;
+    m_hitWidth = width;
+    m_hitHeight = height;
+}
+
+void ZombieSystem::getHitboxes(std::vector<Aabb>& out) const
+{
+    const std::size_t count = m_x.size();
+    out.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = { m_x[i] + m_hitOffsetX, m_y[i] + m_hitOffsetY, m_hitWidth, m_hitHeight };
+}
+
+void ZombieSystem::update(float dt, float targetX, float targetY, const CollisionGrid* walls,
+    const FlowField* flow)
+{
+    m_prevX = m_x; // same size, so a plain copy
+    m_prevY = m_y;
+    steer(targetX, targetY, flow);
+    integrate(dt, walls);
+    animate(dt);
+}
+
+// velocity at the target while it is in range, facing row from it
+void ZombieSystem::steer(float targetX, float targetY, const FlowField* flow)
+{
+    const std::size_t count = m_x.size();
+    const float centreX = m_hitOffsetX + m_hitWidth * 0.5f;
+    const float centreY = m_hitOffsetY + m_hitHeight * 0.5f;
+    const float aggro2 = m_aggroRange * m_aggroRange;
+    const float stop2 = m_stopRange * m_stopRange;
+    const float speed = m_speed;
+
+    float* vx = m_vx.data();
+    float* vy = m_vy.data();
+    const float* x = m_x.data();
+    const float* y = m_y.data();
+    std::uint8_t* state = m_state.data();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float dx = targetX - (x[i] + centreX);
+        float dy = targetY - (y[i] + centreY);
+        float d2 = dx * dx + dy * dy;
+        bool chase = d2 < aggro2 && d2 > stop2;
+        float scale = chase ? speed / std::sqrt(d2) : 0.f;
+        vx[i] = dx * scale;
+        vy[i] = dy * scale;
+        state[i] = chase ? Chase : Idle;
+    }
+
+    // follow the field instead where it knows a way, one lookup per zombie;
+    // on the tile it was built for, within the goal slack of the target, and
+    // where it can't reach, the straight line above is kept
+    if (flow && !flow->empty())
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            float dirX;
+            float dirY;
+            if (state[i] == Chase && flow->sample(x[i] + centreX, y[i] + centreY, dirX, dirY))
+            {
+                vx[i] = dirX * speed;
+                vy[i] = dirY * speed;
+            }
+        }
+    }
+
+    const float threshold = speed * DIRECTION_THRESHOLD;
+    std::uint8_t* rows = m_row.data();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        int h = (vx[i] > threshold) - (vx[i] < -threshold);
+        int v = (vy[i] > threshold) - (vy[i] < -threshold);
+        std::uint8_t row = FACING_ROW[v + 1][h + 1];
+        rows[i] = row == 0xFF ? rows[i] : row;
+    }
+}
+
+void ZombieSystem::integrate(float dt, const CollisionGrid* walls)
+{
+    const std::size_t count = m_x.size();
+    float* x = m_x.data();
+    float* y = m_y.data();
+    const float* vx = m_vx.data();
+    const float* vy = m_vy.data();
+
+    if (!walls || walls->empty())
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+        }
+        return;
+    }
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (vx[i] == 0.f && vy[i] == 0.f)
+            continue;
+
+        Aabb box{ x[i] + m_hitOffsetX, y[i] + m_hitOffsetY, m_hitWidth, m_hitHeight };
+        walls->move(box, vx[i] * dt, vy[i] * dt);
+        x[i] = box.left - m_hitOffsetX;
+        y[i] = box.top - m_hitOffsetY;
+    }
+}
+
+// Player::animate for every zombie at once
+void ZombieSystem::animate(float dt)
+{
+    const std::size_t count = m_x.size();
+    float* frameTime = m_frameTime.data();
+    std::uint8_t* frame = m_frame.data();
+    const std::uint8_t* state = m_state.data();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        bool moving = state[i] == Chase;
+        float time = frameTime[i] + dt;
+        bool advance = moving && time >= FRAME_DURATION;
+        std::uint8_t next = static_cast<std::uint8_t>((frame[i] + 1) % FRAME_COUNT);
+
+        frameTime[i] = moving ? (advance ? 0.f : time) : frameTime[i];
+        frame[i] = moving ? (advance ? next : frame[i]) : 0;
+    }
+}
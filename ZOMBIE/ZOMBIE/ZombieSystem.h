@@ -0,0 +1,77 @@
+#pragma once
+#include "Collision.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class FlowField;
+
+// All zombies of the current room, stored as one array per field so each
+// update pass is a flat loop over contiguous floats the compiler can
+// vectorise. Movement and animation follow Player: 8 frames per row, one
+// row per facing, frame advanced every 0.12s while moving and reset to 0
+// when standing. Positions are the sprite's top left like Player's.
+class ZombieSystem
+{
+public:
+    enum State : std::uint8_t { Idle, Chase };
+
+    static const int FRAME_COUNT = 8;
+    static const int FRAME_WIDTH = 48;
+    static const int FRAME_HEIGHT = 64;
+
+    void reserve(std::size_t count);
+    void clear();
+    std::size_t spawn(float x, float y);
+    void kill(std::size_t index); // swaps the last zombie into its slot
+
+    // feet hitbox relative to the position, used against walls
+    void setHitbox(float offsetX, float offsetY, float width, float height);
+    Aabb getHitbox() const { return { m_hitOffsetX, m_hitOffsetY, m_hitWidth, m_hitHeight }; }
+    // world hitbox of every zombie, for the broadphase
+    void getHitboxes(std::vector<Aabb>& out) const;
+    void setSpeed(float speed) { m_speed = speed; }
+    float getSpeed() const { return m_speed; }
+    void setAggroRange(float range) { m_aggroRange = range; }
+
+    // walk towards the target point, around walls when given the room's
+    // flow field, straight at it otherwise; both are optional
+    void update(float dt, float targetX, float targetY, const CollisionGrid* walls = nullptr,
+        const FlowField* flow = nullptr);
+
+    std::size_t size() const { return m_x.size(); }
+    bool empty() const { return m_x.empty(); }
+
+    const float* getX() const { return m_x.data(); }
+    const float* getY() const { return m_y.data(); }
+    // positions before the last update(), to draw in between ticks
+    const float* getPreviousX() const { return m_prevX.data(); }
+    const float* getPreviousY() const { return m_prevY.data(); }
+    const std::uint8_t* getFrame() const { return m_frame.data(); }
+    const std::uint8_t* getRow() const { return m_row.data(); }
+    const std::uint8_t* getState() const { return m_state.data(); }
+
+private:
+    void steer(float targetX, float targetY, const FlowField* flow);
+    void integrate(float dt, const CollisionGrid* walls);
+    void animate(float dt);
+
+    float m_speed = 120.f;
+    float m_aggroRange = 600.f;
+    float m_stopRange = 24.f; // close enough, stop and stand
+    float m_hitOffsetX = 0.f;
+    float m_hitOffsetY = 0.f;
+    float m_hitWidth = 1.f;
+    float m_hitHeight = 1.f;
+
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_prevX;
+    std::vector<float> m_prevY;
+    std::vector<float> m_vx;
+    std::vector<float> m_vy;
+    std::vector<float> m_frameTime;
+    std::vector<std::uint8_t> m_frame;
+    std::vector<std::uint8_t> m_row;
+    std::vector<std::uint8_t> m_state;
+};
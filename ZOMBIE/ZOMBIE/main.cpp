@@ -21,11 +21,86 @@
 
 
 #include "Game.h"
+#include "Log.h"
+#include "ResourceCache.h"
+#include <cstdlib>
+#include <cstring>
 
-int main()
+int main(int argc, char* argv[])
 {
-	Game game;
-	game.run();
+	// --infinite: endless streamed dungeon instead of the 8x6 map
+	// --load <file>: restore a dungeon saved with F5
+	// --seed <n>: generate this dungeon instead of a random one
+	// --room-size <n>: n x n tile rooms (8 to 512) carved as caves
+	// --pacing vsync|capped|uncapped, --fps <n>: frame pacing, F6 cycles it in game
+	// --record <file>: write every tick's input to file on exit
+	// --replay <file>: play a recording back instead of the keyboard
+	// --headless [--ticks <n>]: no window, run n ticks (default the whole
+	//   replay, or an hour of play) as fast as possible and report ticks/s
+	GameOptions options;
+	FramePacer::Mode pacing = FramePacer::Mode::VSync;
+	double fps = 0.0;
+	std::uint64_t ticks = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--infinite") == 0)
+			options.infiniteDungeon = true;
+		else if (std::strcmp(argv[i], "--headless") == 0)
+			options.headless = true;
+		else if (std::strcmp(argv[i], "--load") == 0 && i + 1 < argc)
+			options.dungeonFile = argv[++i];
+		else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			options.seed = std::strtoull(argv[++i], nullptr, 0);
+		else if (std::strcmp(argv[i], "--room-size") == 0 && i + 1 < argc)
+			options.roomSize = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+			options.recordFile = argv[++i];
+		else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+			options.replayFile = argv[++i];
+		else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+			ticks = std::strtoull(argv[++i], nullptr, 0);
+		else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+			fps = std::atof(argv[++i]);
+		else if (std::strcmp(argv[i], "--pacing") == 0 && i + 1 < argc)
+		{
+			const char* mode = argv[++i];
+			if (std::strcmp(mode, "capped") == 0)
+				pacing = FramePacer::Mode::Capped;
+			else if (std::strcmp(mode, "uncapped") == 0)
+				pacing = FramePacer::Mode::Uncapped;
+		}
+	}
+
+	if (options.headless)
+	{
+		bool ok;
+		{
+			Game game(options);
+			if (ticks == 0 && game.getReplayLength() == 0)
+				ticks = 60 * 60 * 60;
+			ok = game.runHeadless(ticks);
+		}
+		Logger::instance().shutdown();
+		return ok ? 0 : 1;
+	}
+
+	// decode the art on worker threads while the window is being created
+	ResourceCache::instance().preload({
+		"ASSETS/IMAGES/walk.png",
+		"ASSETS/IMAGES/floor.png",
+		"ASSETS/IMAGES/wall.png",
+		"ASSETS/IMAGES/wall_centre.png",
+		"ASSETS/IMAGES/right_wall.png",
+		"ASSETS/IMAGES/wall_left.png",
+		"ASSETS/IMAGES/wall_right.png",
+		"ASSETS/IMAGES/wall_bottom.png" });
+
+	{
+		Game game(options);
+		game.setFramePacing(pacing, fps);
+		game.run();
+	}
+	Logger::instance().shutdown(); // flush whatever is still queued
 
 	return 1;
-}
\ No newline at end of file
+}
@@ -0,0 +1,995 @@
+/// <summary>
+/// @description Headless benchmarks for the game core.
+/// Links ZOMBIE_CORE only, no SFML, so it runs on build boxes.
+///
+/// usage: ZOMBIE_BENCH [throughput|scaling|zombies|flowfield|roompath|broadphase|dungeonfile|connectivity|bitboard|caves|doors] [maxGrid] [runs]
+///   throughput - generate() time, rooms/s, peak memory and time per
+///                phase for grids from 8x6 up to 4096x4096 rooms
+///   scaling    - parallel interiors with 1/2/4/8/N threads on grids
+///                from 64x64 up, checked against the serial result
+///   zombies    - ZombieSystem::update() for 1k/10k/50k chasing zombies,
+///                open floor and against room walls, one core
+///   flowfield  - FlowField rebuild time for rooms from 10x10 up to
+///                512x512 tiles, 30% scattered walls, and the mean cost
+///                per tick of a goal walking a tile a tick with the
+///                game's goal slack
+///   roompath   - RoomPathfinder queries between random rooms, also with
+///                the goal room's FlowField, against a breadth-first
+///                search over the whole room grid
+///   broadphase - SpatialGrid rebuild, overlap pairs and radius queries
+///                for 1k/10k/50k boxes against the naive all-pairs test
+///   dungeonfile - DungeonFile save, mapped open, an in-place scan of every
+///                tile and a full load back, checked against the original
+///   connectivity - MapGenerator::isReachable() between random active rooms
+///                against a breadth-first search, answers compared
+///   bitboard   - layout passes (all but interiors) of the Rooms and
+///                Bitboard backends from 256x256 up, dungeons compared
+///   caves      - CaveGenerator for rooms from 16x16 to 512x512 tiles, alone
+///                and as a whole room, checked against a tile-at-a-time version
+///   doors      - DoorConnector check and repair on prefab and cave rooms,
+///                checked with a tile-at-a-time flood
+/// </summary>
+
+#include "CaveGenerator.h"
+#include "Collision.h"
+#include "DoorConnector.h"
+#include "DungeonFile.h"
+#include "FlowField.h"
+#include "MapGenerator.h"
+#include "Random.h"
+#include "RoomPathfinder.h"
+#include "RoomPrefabs.h"
+#include "SpatialGrid.h"
+#include "ZombieSystem.h"
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    const std::uint64_t BENCH_SEED = 0x5EED2024ull;
+
+    // process high-water mark in MiB
+    double peakMemoryMiB()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return 0.0;
+        return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0.0;
+#ifdef __APPLE__
+        return usage.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+        return usage.ru_maxrss / 1024.0; // KiB
+#endif
+#endif
+    }
+
+    double elapsedMs(std::chrono::steady_clock::time_point since)
+    {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - since).count();
+    }
+
+    // FNV-1a over everything generate() writes
+    std::uint64_t hashDungeon(const MapGenerator& map)
+    {
+        std::uint64_t h = 1469598103934665603ull;
+        auto add = [&h](std::uint64_t v)
+        {
+            h ^= v;
+            h *= 1099511628211ull;
+        };
+
+        for (int y = 0; y < map.getRoomsY(); ++y)
+        {
+            for (int x = 0; x < map.getRoomsX(); ++x)
+            {
+                const MapGenerator::Room& room = map.getRoom(x, y);
+                add(room.active);
+                add(static_cast<std::uint64_t>(room.type));
+                add(room.exitUp | room.exitDown << 1 | room.exitLeft << 2 | room.exitRight << 3);
+
+                const TileGrid& tiles = room.tiles;
+                for (int ty = 0; ty < tiles.getHeight(); ++ty)
+                {
+                    const std::uint8_t* row = tiles.row(ty);
+                    for (int tx = 0; tx < tiles.getWidth(); ++tx)
+                        add(row[tx]);
+                }
+            }
+        }
+        return h;
+    }
+
+    // every room's component size and whether it reaches the start room,
+    // so backends with differently built indices can be compared
+    std::uint64_t hashComponents(const MapGenerator& map)
+    {
+        std::uint64_t h = 1469598103934665603ull;
+        for (int y = 0; y < map.getRoomsY(); ++y)
+        {
+            for (int x = 0; x < map.getRoomsX(); ++x)
+            {
+                const MapGenerator::RoomPos room{ x, y };
+                h ^= static_cast<std::uint64_t>(map.getComponentSize(room)) << 1
+                    | map.isReachable(room, map.getStartRoom());
+                h *= 1099511628211ull;
+            }
+        }
+        return h;
+    }
+
+    // runs generate() and keeps the phase times of the median run
+    double timeGenerate(MapGenerator& map, int runs, MapGenerator::PhaseTimes* phases = nullptr)
+    {
+        std::vector<std::pair<double, MapGenerator::PhaseTimes>> results;
+        for (int i = 0; i < runs; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            map.generate(BENCH_SEED);
+            results.push_back({ elapsedMs(start), map.getPhaseTimes() });
+        }
+        std::sort(results.begin(), results.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        const auto& median = results[results.size() / 2];
+        if (phases)
+            *phases = median.second;
+        return median.first;
+    }
+
+    void throughputReport(int maxGrid, int runs)
+    {
+        const int sizes[][2] = {
+            { 8, 6 }, { 32, 32 }, { 64, 64 }, { 128, 128 }, { 256, 256 },
+            { 512, 512 }, { 1024, 1024 }, { 2048, 2048 }, { 4096, 4096 } };
+
+        std::printf("throughput, seed %llu, median of up to %d runs, serial\n\n",
+            static_cast<unsigned long long>(BENCH_SEED), runs);
+        std::printf("%11s %10s %10s %9s %10s %11s %9s | %8s %8s %8s %8s %8s %8s %9s\n",
+            "grid", "rooms", "active", "alloc ms", "gen ms", "Mrooms/s", "peak MiB",
+            "reset", "shaft", "side", "exits", "boss", "types", "interior");
+
+        for (const auto& size : sizes)
+        {
+            const int roomsX = size[0];
+            const int roomsY = size[1];
+            if (std::max(roomsX, roomsY) > maxGrid)
+                break;
+
+            const long long rooms = static_cast<long long>(roomsX) * roomsY;
+            // the big grids take seconds each, one pass is enough
+            const int sizeRuns = rooms >= (1 << 20) ? 1 : runs;
+
+            auto start = std::chrono::steady_clock::now();
+            MapGenerator map(roomsX, roomsY);
+            double allocMs = elapsedMs(start);
+
+            MapGenerator::PhaseTimes phases;
+            double ms = timeGenerate(map, sizeRuns, &phases);
+
+            long long active = 0;
+            for (int y = 0; y < roomsY; ++y)
+                for (int x = 0; x < roomsX; ++x)
+                    active += map.getRoom(x, y).active;
+
+            char label[32];
+            std::snprintf(label, sizeof(label), "%dx%d", roomsX, roomsY);
+            std::printf("%11s %10lld %10lld %9.2f %10.2f %11.2f %9.1f | %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %9.2f\n",
+                label, rooms, active, allocMs, ms, rooms / (ms * 1000.0), peakMemoryMiB(),
+                phases.reset, phases.mainShaft, phases.sideRooms, phases.exits,
+                phases.bossSearch, phases.roomTypes, phases.interiors);
+        }
+    }
+
+    bool scalingReport(int maxGrid, int runs)
+    {
+        unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<unsigned> threadCounts = { 1, 2, 4, 8 };
+        if (std::find(threadCounts.begin(), threadCounts.end(), hardware) == threadCounts.end())
+            threadCounts.push_back(hardware);
+
+        std::printf("scaling, hardware threads: %u, seed: %llu, median of %d runs\n\n",
+            hardware, static_cast<unsigned long long>(BENCH_SEED), runs);
+        std::printf("%10s %8s %12s %12s %9s %11s %10s\n",
+            "grid", "threads", "generate ms", "interior ms", "speedup", "efficiency", "identical");
+
+        bool allIdentical = true;
+        for (int grid = 64; grid <= maxGrid; grid *= 2)
+        {
+            MapGenerator map(grid, grid);
+            map.generate(BENCH_SEED);
+            const std::uint64_t reference = hashDungeon(map);
+
+            double serialMs = 0.0;
+            for (unsigned threads : threadCounts)
+            {
+                map.setThreadCount(threads);
+                MapGenerator::PhaseTimes phases;
+                double ms = timeGenerate(map, runs, &phases);
+                if (threads == 1)
+                    serialMs = ms;
+
+                bool identical = hashDungeon(map) == reference;
+                allIdentical = allIdentical && identical;
+
+                char label[32];
+                std::snprintf(label, sizeof(label), "%dx%d", grid, grid);
+                std::printf("%10s %8u %12.2f %12.2f %8.2fx %10.0f%% %10s\n",
+                    label, threads, ms, phases.interiors, serialMs / ms,
+                    100.0 * serialMs / (ms * threads), identical ? "yes" : "NO");
+            }
+            std::printf("\n");
+        }
+        return allIdentical;
+    }
+
+    // median microseconds per update over `ticks` steps of a 60Hz game
+    double timeZombies(ZombieSystem& zombies, const CollisionGrid* walls, int ticks)
+    {
+        const float dt = 1.f / 60.f;
+        std::vector<double> samples;
+        samples.reserve(ticks);
+        for (int tick = 0; tick < ticks; ++tick)
+        {
+            // target circles the room so the horde keeps walking
+            float angle = tick * dt;
+            float targetX = 600.f + 300.f * std::cos(angle);
+            float targetY = 500.f + 250.f * std::sin(angle);
+
+            auto start = std::chrono::steady_clock::now();
+            zombies.update(dt, targetX, targetY, walls);
+            samples.push_back(elapsedMs(start) * 1000.0);
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    bool zombiesReport(int runs)
+    {
+        // one room the size of the game's, border walls and a pillar
+        TileGrid room;
+        room.resize(10, 10);
+        for (int i = 0; i < 10; ++i)
+        {
+            room.set(i, 0, TileGrid::Wall);
+            room.set(i, 9, TileGrid::Wall);
+            room.set(0, i, TileGrid::Wall);
+            room.set(9, i, TileGrid::Wall);
+        }
+        room.set(4, 4, TileGrid::Wall);
+        room.set(5, 4, TileGrid::Wall);
+
+        CollisionGrid walls;
+        walls.build(room, 120.f, 100.f);
+
+        const int ticks = 200 * runs;
+        std::printf("zombies, median of %d ticks, one core, budget 1000 us at 10k\n\n", ticks);
+        std::printf("%8s %12s %12s %12s %12s\n", "zombies", "open us", "walls us", "open ns/z", "walls ns/z");
+
+        bool withinBudget = true;
+        for (int count : { 1000, 10000, 50000 })
+        {
+            ZombieSystem zombies;
+            zombies.reserve(count);
+            zombies.setHitbox(33.6f, 56.3f, 28.8f, 15.4f);
+            zombies.setAggroRange(1e6f);
+
+            Rng rng = Rng::stream(BENCH_SEED, 0);
+            for (int i = 0; i < count; ++i)
+                zombies.spawn(130.f + rng.nextInt(900), 110.f + rng.nextInt(700));
+
+            double openUs = timeZombies(zombies, nullptr, ticks);
+            double wallsUs = timeZombies(zombies, &walls, ticks);
+            if (count == 10000)
+                withinBudget = wallsUs < 1000.0;
+
+            std::printf("%8d %12.1f %12.1f %12.2f %12.2f\n", count, openUs, wallsUs,
+                openUs * 1000.0 / count, wallsUs * 1000.0 / count);
+        }
+        return withinBudget;
+    }
+
+    void flowFieldReport(int runs)
+    {
+        std::printf("flowfield, goal moved one tile per rebuild, median of %d rebuilds\n", 50 * runs);
+        std::printf("walk: goal moved one tile per update with the game's 48 px slack, mean per update\n\n");
+        std::printf("%10s %10s %12s %12s %8s %12s\n", "room", "tiles", "rebuild us", "ns/tile", "slack", "walk us");
+
+        for (int size : { 10, 32, 64, 128, 256, 512 })
+        {
+            TileGrid room;
+            room.resize(size, size);
+            Rng rng = Rng::stream(BENCH_SEED, 1, size);
+            for (int y = 0; y < size; ++y)
+                for (int x = 0; x < size; ++x)
+                    if (rng.nextInt(100) < 30)
+                        room.set(x, y, TileGrid::Wall);
+
+            FlowField field;
+            std::vector<double> samples;
+            for (int i = 0; i < 50 * runs; ++i)
+            {
+                // walk the goal along the middle row so every call rebuilds
+                int goalX = i % size;
+                room.set(goalX, size / 2, TileGrid::Floor);
+
+                auto start = std::chrono::steady_clock::now();
+                field.update(room, 1.f, 1.f, goalX, size / 2);
+                samples.push_back(elapsedMs(start) * 1000.0);
+            }
+            std::sort(samples.begin(), samples.end());
+            double us = samples[samples.size() / 2];
+
+            // as Game sets it: 48 world px over a 1200 px wide room
+            const int slack = static_cast<int>(48.f / (1200.f / size));
+            field.setGoalSlack(slack);
+            field.invalidate();
+            const int steps = 50 * runs * (slack + 1);
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < steps; ++i)
+                field.update(room, 1.f, 1.f, i % size, size / 2);
+            double walkUs = elapsedMs(start) * 1000.0 / steps;
+
+            char label[32];
+            std::snprintf(label, sizeof(label), "%dx%d", size, size);
+            std::printf("%10s %10d %12.1f %12.2f %8d %12.1f\n", label, size * size, us, us * 1000.0 / (size * size),
+                slack, walkUs);
+        }
+    }
+
+    // CaveGenerator one tile at a time, the straightforward way: same noise
+    // draws, then each pass counts the 3x3 walls around every tile
+    void scalarCave(TileGrid& tiles, int width, int height, Rng& rng)
+    {
+        const int words = (width + 63) / 64;
+        std::vector<std::uint8_t> cells(static_cast<std::size_t>(width) * height);
+        std::vector<std::uint8_t> next(cells.size());
+        for (int y = 0; y < height; ++y)
+        {
+            for (int w = 0; w < words; ++w)
+            {
+                const std::uint64_t r0 = rng.next();
+                const std::uint64_t r1 = rng.next();
+                const std::uint64_t r2 = rng.next();
+                const std::uint64_t r3 = rng.next();
+                const std::uint64_t noise = CaveGenerator::noise(width, height, r0, r1, r2, r3);
+                for (int bit = 0; bit < 64 && w * 64 + bit < width; ++bit)
+                {
+                    const int x = w * 64 + bit;
+                    const bool edge = y == 0 || y == height - 1 || x == 0 || x == width - 1;
+                    cells[static_cast<std::size_t>(y) * width + x] = edge || ((noise >> bit) & 1);
+                }
+            }
+        }
+
+        for (int pass = 0; pass < CaveGenerator::PASSES; ++pass)
+        {
+            next = cells;
+            for (int y = 1; y < height - 1; ++y)
+            {
+                for (int x = 1; x < width - 1; ++x)
+                {
+                    int walls = 0;
+                    for (int dy = -1; dy <= 1; ++dy)
+                        for (int dx = -1; dx <= 1; ++dx)
+                            walls += cells[static_cast<std::size_t>(y + dy) * width + x + dx];
+                    next[static_cast<std::size_t>(y) * width + x] = walls >= 5;
+                }
+            }
+            cells.swap(next);
+        }
+
+        tiles.resize(width, height);
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+                tiles.set(x, y, cells[static_cast<std::size_t>(y) * width + x] ? TileGrid::Wall : TileGrid::Floor);
+    }
+
+    bool cavesReport(int runs)
+    {
+        std::printf("caves, CaveGenerator against a tile-at-a-time version, median of %d rooms\n\n", 10 * runs);
+        std::printf("%10s %10s %10s %10s %12s %10s %8s %6s\n",
+            "room", "tiles", "cave us", "room us", "scalar us", "speedup", "wall %", "same");
+
+        bool allSame = true;
+        CaveGenerator caves;
+        for (int size : { 16, 32, 64, 128, 256, 512 })
+        {
+            TileGrid fast;
+            TileGrid slow;
+            MapGenerator::Room room;
+            room.active = true;
+            room.type = MapGenerator::Room::RoomType::Normal;
+            room.exitUp = room.exitDown = room.exitLeft = room.exitRight = true;
+
+            std::vector<double> caveSamples;
+            std::vector<double> roomSamples;
+            std::vector<double> scalarSamples;
+            bool same = true;
+            std::size_t walls = 0;
+            for (int i = 0; i < 10 * runs; ++i)
+            {
+                Rng rng = Rng::stream(BENCH_SEED, 4, size, i);
+                auto start = std::chrono::steady_clock::now();
+                caves.generate(fast, size, size, rng);
+                caveSamples.push_back(elapsedMs(start) * 1000.0);
+
+                // the whole room as generate() builds it, doors included
+                start = std::chrono::steady_clock::now();
+                MapGenerator::generateRoomLayout(room, BENCH_SEED, size, i, size, size);
+                roomSamples.push_back(elapsedMs(start) * 1000.0);
+
+                // the slow one is slow, a few are enough
+                if (i < runs)
+                {
+                    rng = Rng::stream(BENCH_SEED, 4, size, i);
+                    start = std::chrono::steady_clock::now();
+                    scalarCave(slow, size, size, rng);
+                    scalarSamples.push_back(elapsedMs(start) * 1000.0);
+                    for (int y = 0; y < size; ++y)
+                        same = same && std::memcmp(fast.row(y), slow.row(y), size) == 0;
+                }
+                for (int y = 0; y < size; ++y)
+                    for (int x = 0; x < size; ++x)
+                        walls += fast.isWall(x, y);
+            }
+            for (auto* samples : { &caveSamples, &roomSamples, &scalarSamples })
+                std::sort(samples->begin(), samples->end());
+            allSame = allSame && same;
+
+            const double caveUs = caveSamples[caveSamples.size() / 2];
+            const double scalarUs = scalarSamples[scalarSamples.size() / 2];
+            char label[32];
+            std::snprintf(label, sizeof(label), "%dx%d", size, size);
+            std::printf("%10s %10d %10.1f %10.1f %12.1f %9.0fx %8.1f %6s\n", label, size * size, caveUs,
+                roomSamples[roomSamples.size() / 2], scalarUs, scalarUs / caveUs,
+                100.0 * walls / (10.0 * runs * size * size), same ? "yes" : "NO");
+        }
+        return allSame;
+    }
+
+    // floor tiles reachable from (x, y), 4-way, one at a time
+    int floodCount(const TileGrid& tiles, int x, int y, std::vector<std::uint8_t>& seen)
+    {
+        const int width = tiles.getWidth();
+        const int height = tiles.getHeight();
+        seen.assign(static_cast<std::size_t>(width) * height, 0);
+        std::vector<int> stack{ y * width + x };
+        seen[stack.back()] = 1;
+        int count = 0;
+        while (!stack.empty())
+        {
+            const int tile = stack.back();
+            stack.pop_back();
+            ++count;
+            const int tx = tile % width;
+            const int ty = tile / width;
+            const int next[4][2] = { { tx + 1, ty }, { tx - 1, ty }, { tx, ty + 1 }, { tx, ty - 1 } };
+            for (const auto& n : next)
+            {
+                if (n[0] < 0 || n[1] < 0 || n[0] >= width || n[1] >= height || tiles.isWall(n[0], n[1]))
+                    continue;
+                const int index = n[1] * width + n[0];
+                if (!seen[index])
+                {
+                    seen[index] = 1;
+                    stack.push_back(index);
+                }
+            }
+        }
+        return count;
+    }
+
+    bool doorsReport(int runs)
+    {
+        std::printf("doors, DoorConnector on rooms with all 4 doors cut, median of %d rooms\n", 20 * runs);
+        std::printf("10x10 rooms are prefabs, the rest caves; checked by a tile-at-a-time flood\n\n");
+        std::printf("%10s %10s %12s %10s %12s %12s %6s\n",
+            "room", "tiles", "connect us", "repaired", "carved/room", "walled in %", "ok");
+
+        bool allOk = true;
+        CaveGenerator caves;
+        DoorConnector connector;
+        std::vector<std::uint8_t> seen;
+        for (int size : { 10, 16, 32, 64, 128, 256, 512 })
+        {
+            const int mid = size / 2;
+            const DoorConnector::Door doors[4] = { { mid, 0 }, { mid, size - 1 }, { 0, mid }, { size - 1, mid } };
+            const int rooms = 20 * runs;
+            std::vector<double> samples;
+            int repaired = 0;
+            long long carved = 0;
+            long long floorBefore = 0;
+            long long floorAfter = 0;
+            bool ok = true;
+            TileGrid tiles;
+            for (int i = 0; i < rooms; ++i)
+            {
+                Rng rng = Rng::stream(BENCH_SEED, 5, size, i);
+                if (size == RoomPrefabs::SIZE)
+                {
+                    const auto type = static_cast<MapGenerator::Room::RoomType>(1 + i % 5);
+                    RoomPrefabs::stamp(tiles, type, rng.nextInt(RoomPrefabs::getCount(type)), rng.nextInt(RoomPrefabs::TRANSFORMS));
+                }
+                else
+                {
+                    caves.generate(tiles, size, size, rng);
+                }
+                // the gaps generateRoomLayout cuts
+                for (int d = -1; d <= 1; ++d)
+                {
+                    for (int depth = 0; depth < 2; ++depth)
+                    {
+                        tiles.set(mid + d, depth, TileGrid::Floor);
+                        tiles.set(mid + d, size - 1 - depth, TileGrid::Floor);
+                        tiles.set(depth, mid + d, TileGrid::Floor);
+                        tiles.set(size - 1 - depth, mid + d, TileGrid::Floor);
+                    }
+                }
+                for (int y = 0; y < size; ++y)
+                    for (int x = 0; x < size; ++x)
+                        floorBefore += !tiles.isWall(x, y);
+
+                auto start = std::chrono::steady_clock::now();
+                const int roomCarved = connector.connect(tiles, doors, 4);
+                samples.push_back(elapsedMs(start) * 1000.0);
+                repaired += roomCarved > 0;
+                carved += roomCarved;
+
+                // every door reached, and every floor tile with them
+                int floor = 0;
+                for (int y = 0; y < size; ++y)
+                    for (int x = 0; x < size; ++x)
+                        floor += !tiles.isWall(x, y);
+                floorAfter += floor;
+                ok = ok && floodCount(tiles, doors[0].x, doors[0].y, seen) == floor;
+                for (const auto& door : doors)
+                    ok = ok && seen[static_cast<std::size_t>(door.y) * size + door.x];
+            }
+            std::sort(samples.begin(), samples.end());
+            allOk = allOk && ok;
+
+            char label[32];
+            std::snprintf(label, sizeof(label), "%dx%d", size, size);
+            std::printf("%10s %10d %12.2f %9.0f%% %12.1f %12.1f %6s\n", label, size * size, samples[samples.size() / 2],
+                100.0 * repaired / rooms, static_cast<double>(carved) / rooms,
+                100.0 * (floorBefore + carved - floorAfter) / floorBefore, ok ? "yes" : "NO");
+        }
+        return allOk;
+    }
+
+    // the baseline: BFS over every room, as generate() does from the start room
+    int roomGridDistance(const MapGenerator& map, MapGenerator::RoomPos from, MapGenerator::RoomPos to,
+        std::vector<int>& distance, std::vector<int>& queue)
+    {
+        const int roomsX = map.getRoomsX();
+        distance.assign(static_cast<std::size_t>(roomsX) * map.getRoomsY(), -1);
+        queue.clear();
+        distance[from.y * roomsX + from.x] = 0;
+        queue.push_back(from.y * roomsX + from.x);
+
+        for (std::size_t head = 0; head < queue.size(); ++head)
+        {
+            const int index = queue[head];
+            const int x = index % roomsX;
+            const int y = index / roomsX;
+            if (x == to.x && y == to.y)
+                return distance[index];
+
+            const MapGenerator::Room& room = map.getRoom(x, y);
+            const int next[4][3] = {
+                { x, y - 1, room.exitUp && y > 0 && map.getRoom(x, y - 1).exitDown },
+                { x + 1, y, room.exitRight && x < roomsX - 1 && map.getRoom(x + 1, y).exitLeft },
+                { x, y + 1, room.exitDown && y < map.getRoomsY() - 1 && map.getRoom(x, y + 1).exitUp },
+                { x - 1, y, room.exitLeft && x > 0 && map.getRoom(x - 1, y).exitRight } };
+            for (const auto& n : next)
+            {
+                const int ni = n[1] * roomsX + n[0];
+                if (n[2] && map.getRoom(n[0], n[1]).active && distance[ni] < 0)
+                {
+                    distance[ni] = distance[index] + 1;
+                    queue.push_back(ni);
+                }
+            }
+        }
+        return -1;
+    }
+
+    bool connectivityReport(int maxGrid, int runs)
+    {
+        const int queries = 100000 * runs;
+        const int bfsQueries = 20 * runs;
+        std::printf("connectivity, seed %llu, %d index queries and %d BFS per grid\n\n",
+            static_cast<unsigned long long>(BENCH_SEED), queries, bfsQueries);
+        std::printf("%10s %10s %10s %12s %12s %12s %10s %6s\n",
+            "grid", "active", "exits ms", "query ns", "BFS us", "speedup", "start comp", "same");
+
+        bool allSame = true;
+        for (int grid = 64; grid <= std::min(maxGrid, 2048); grid *= 2)
+        {
+            MapGenerator map(grid, grid);
+            MapGenerator::PhaseTimes phases;
+            timeGenerate(map, runs, &phases);
+
+            std::vector<MapGenerator::RoomPos> active;
+            for (int y = 0; y < grid; ++y)
+                for (int x = 0; x < grid; ++x)
+                    if (map.getRoom(x, y).active)
+                        active.push_back({ x, y });
+
+            Rng rng = Rng::stream(BENCH_SEED, 3, grid);
+            std::vector<std::pair<MapGenerator::RoomPos, MapGenerator::RoomPos>> pairs(queries);
+            for (auto& pair : pairs)
+            {
+                pair.first = active[rng.nextInt(static_cast<int>(active.size()))];
+                pair.second = active[rng.nextInt(static_cast<int>(active.size()))];
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            int reachable = 0;
+            for (const auto& pair : pairs)
+                reachable += map.isReachable(pair.first, pair.second);
+            const double queryNs = elapsedMs(start) * 1e6 / queries;
+
+            // the old way: a search over the room grid per question
+            std::vector<int> distance;
+            std::vector<int> queue;
+            bool same = reachable > 0;
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < bfsQueries; ++i)
+            {
+                const auto& pair = pairs[i];
+                bool found = roomGridDistance(map, pair.first, pair.second, distance, queue) >= 0;
+                same = same && found == map.isReachable(pair.first, pair.second);
+            }
+            const double bfsUs = elapsedMs(start) * 1000.0 / bfsQueries;
+            allSame = allSame && same;
+
+            char label[32];
+            std::snprintf(label, sizeof(label), "%dx%d", grid, grid);
+            std::printf("%10s %10zu %10.2f %12.1f %12.1f %11.0fx %10d %6s\n", label, active.size(),
+                phases.exits, queryNs, bfsUs, bfsUs * 1000.0 / queryNs,
+                map.getComponentSize(map.getStartRoom()), same ? "yes" : "NO");
+        }
+        return allSame;
+    }
+
+    struct BackendRun
+    {
+        MapGenerator::PhaseTimes phases;
+        std::uint64_t hash = 0;
+        std::uint64_t components = 0;
+        MapGenerator::RoomPos boss;
+
+        double layout() const { return phases.total() - phases.interiors; }
+    };
+
+    // one backend at a time, two 4096x4096 maps don't fit everywhere
+    BackendRun runBackend(MapGenerator::Backend backend, int grid, int runs)
+    {
+        MapGenerator map(grid, grid);
+        map.setBackend(backend);
+        BackendRun run;
+        timeGenerate(map, runs, &run.phases);
+        run.hash = hashDungeon(map);
+        run.boss = map.getBossRoom();
+        run.components = hashComponents(map);
+        return run;
+    }
+
+    bool bitboardReport(int maxGrid, int runs)
+    {
+        // the Bitboard backend writes the rooms out in its interiors pass, gen has it
+        std::printf("bitboard, seed %llu, median of %d runs, serial, layout = all passes but interiors\n\n",
+            static_cast<unsigned long long>(BENCH_SEED), runs);
+        std::printf("%10s %11s %11s %8s %11s %11s | %8s %8s %8s %8s %8s %8s | %6s\n", "grid", "rooms ms",
+            "bitboard ms", "speedup", "rooms gen", "bits gen", "reset", "shaft", "side", "exits", "boss", "types",
+            "same");
+
+        bool allSame = true;
+        for (int grid = 256; grid <= std::min(maxGrid, 4096); grid *= 2)
+        {
+            const BackendRun rooms = runBackend(MapGenerator::Backend::Rooms, grid, runs);
+            const BackendRun bits = runBackend(MapGenerator::Backend::Bitboard, grid, runs);
+            const bool same = rooms.hash == bits.hash && rooms.boss == bits.boss
+                && rooms.components == bits.components;
+            allSame = allSame && same;
+
+            const MapGenerator::PhaseTimes& p = bits.phases;
+            char label[32];
+            std::snprintf(label, sizeof(label), "%dx%d", grid, grid);
+            std::printf("%10s %11.2f %11.2f %7.1fx %11.2f %11.2f | %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f | %6s\n",
+                label, rooms.layout(), bits.layout(), rooms.layout() / bits.layout(), rooms.phases.total(),
+                p.total(), p.reset, p.mainShaft, p.sideRooms, p.exits, p.bossSearch, p.roomTypes,
+                same ? "yes" : "NO");
+        }
+        return allSame;
+    }
+
+    void roomPathReport(int maxGrid, int runs)
+    {
+        std::printf("roompath, seed %llu, %d queries per grid between rooms linked to the start\n\n",
+            static_cast<unsigned long long>(BENCH_SEED), 200 * runs);
+        // interior walls can cut a room's doors apart, so not every pair
+        // linked by exits has a walkable path
+        // field us: the same query with the goal room's leg read from a
+        // FlowField, as the game has one towards the player already
+        std::printf("%10s %8s %10s %12s %12s %12s %12s %10s %8s\n",
+            "grid", "rooms", "build ms", "query us", "found us", "field us", "grid BFS us", "expanded", "found");
+
+        for (int grid = 16; grid <= std::min(maxGrid, 256); grid *= 2)
+        {
+            MapGenerator map(grid, grid);
+            map.generate(BENCH_SEED);
+
+            auto start = std::chrono::steady_clock::now();
+            RoomPathfinder pathfinder;
+            pathfinder.build(map);
+            double buildMs = elapsedMs(start);
+
+            // rooms linked to the start room, the part of the dungeon the player can walk
+            std::vector<int> distance;
+            std::vector<int> queue;
+            roomGridDistance(map, map.getStartRoom(), { -1, -1 }, distance, queue);
+            std::vector<MapGenerator::RoomPos> active;
+            for (int index : queue)
+                active.push_back({ index % grid, index / grid });
+
+            Rng rng = Rng::stream(BENCH_SEED, 2, grid);
+            std::vector<RoomPathfinder::Waypoint> path;
+            std::vector<double> querySamples;
+            std::vector<double> foundSamples;
+            std::vector<double> fieldSamples;
+            std::vector<double> bfsSamples;
+            FlowField field;
+            long long expanded = 0;
+            int found = 0;
+            const int queries = 200 * runs;
+            for (int i = 0; i < queries; ++i)
+            {
+                MapGenerator::RoomPos from = active[rng.nextInt(static_cast<int>(active.size()))];
+                MapGenerator::RoomPos to = active[rng.nextInt(static_cast<int>(active.size()))];
+                const int mid = map.getRoomWidth() / 2;
+                // the goal is where a player could stand, the first floor tile from the middle on
+                const TileGrid& goalTiles = map.getRoom(to.x, to.y).tiles;
+                int goal = mid * map.getRoomWidth() + mid;
+                while (goal + 1 < map.getRoomWidth() * map.getRoomHeight()
+                    && goalTiles.get(goal % map.getRoomWidth(), goal / map.getRoomWidth()) == TileGrid::Wall)
+                    ++goal;
+                const int goalX = goal % map.getRoomWidth();
+                const int goalY = goal / map.getRoomWidth();
+
+                start = std::chrono::steady_clock::now();
+                bool ok = pathfinder.findPath(from, mid, mid, to, goalX, goalY, path);
+                double us = elapsedMs(start) * 1000.0;
+                querySamples.push_back(us);
+                if (ok)
+                    foundSamples.push_back(us);
+                found += ok;
+                expanded += pathfinder.getNodesExpanded();
+
+                field.update(goalTiles, 1.f, 1.f, goalX, goalY);
+                start = std::chrono::steady_clock::now();
+                pathfinder.findPath(from, mid, mid, to, field, path);
+                fieldSamples.push_back(elapsedMs(start) * 1000.0);
+
+                start = std::chrono::steady_clock::now();
+                roomGridDistance(map, from, to, distance, queue);
+                bfsSamples.push_back(elapsedMs(start) * 1000.0);
+            }
+            std::sort(querySamples.begin(), querySamples.end());
+            std::sort(foundSamples.begin(), foundSamples.end());
+            std::sort(fieldSamples.begin(), fieldSamples.end());
+            std::sort(bfsSamples.begin(), bfsSamples.end());
+            double foundUs = foundSamples.empty() ? 0.0 : foundSamples[foundSamples.size() / 2];
+
+            char label[32];
+            std::snprintf(label, sizeof(label), "%dx%d", grid, grid);
+            std::printf("%10s %8zu %10.2f %12.2f %12.2f %12.2f %12.2f %10lld %7d%%\n", label, active.size(),
+                buildMs, querySamples[queries / 2], foundUs, fieldSamples[queries / 2], bfsSamples[queries / 2],
+                expanded / queries, 100 * found / queries);
+        }
+    }
+
+    bool dungeonFileReport(int maxGrid, int runs)
+    {
+        const char* path = "bench_dungeon.zdn";
+        std::printf("dungeonfile, seed %llu, median of %d runs\n\n",
+            static_cast<unsigned long long>(BENCH_SEED), runs);
+        std::printf("%10s %10s %10s %10s %10s %10s %10s %6s\n",
+            "grid", "rooms", "MiB", "save ms", "open us", "scan ms", "load ms", "same");
+
+        bool allSame = true;
+        // the generator itself needs ~150 bytes a room, so stop at 4M rooms
+        for (int grid = 64; grid <= std::min(maxGrid, 2048); grid *= 2)
+        {
+            MapGenerator map(grid, grid);
+            map.generate(BENCH_SEED);
+            const std::uint64_t expected = hashDungeon(map);
+
+            std::vector<double> saveSamples;
+            std::vector<double> openSamples;
+            std::vector<double> scanSamples;
+            std::vector<double> loadSamples;
+            bool same = true;
+            long long walls = 0;
+            MapGenerator loaded(1, 1);
+            for (int run = 0; run < runs; ++run)
+            {
+                auto start = std::chrono::steady_clock::now();
+                if (!DungeonFile::save(map, path))
+                {
+                    std::printf("could not write %s\n", path);
+                    return false;
+                }
+                saveSamples.push_back(elapsedMs(start));
+
+                start = std::chrono::steady_clock::now();
+                DungeonView view;
+                if (!view.open(path))
+                {
+                    std::printf("could not map %s\n", path);
+                    return false;
+                }
+                openSamples.push_back(elapsedMs(start) * 1000.0);
+
+                // reads straight from the mapping, first touch pages it in
+                start = std::chrono::steady_clock::now();
+                walls = 0;
+                for (int y = 0; y < grid; ++y)
+                    for (int x = 0; x < grid; ++x)
+                        if (view.isActive(x, y))
+                            for (int ty = 0; ty < view.getRoomHeight(); ++ty)
+                                for (int tx = 0; tx < view.getRoomWidth(); ++tx)
+                                    walls += view.isWall(x, y, tx, ty);
+                scanSamples.push_back(elapsedMs(start));
+
+                start = std::chrono::steady_clock::now();
+                loaded.load(view);
+                loadSamples.push_back(elapsedMs(start));
+                same = same && hashDungeon(loaded) == expected
+                    && loaded.getStartRoom() == map.getStartRoom()
+                    && loaded.getBossRoom() == map.getBossRoom()
+                    && loaded.getSeed() == map.getSeed();
+            }
+            std::remove(path);
+            allSame = allSame && same;
+
+            for (auto* samples : { &saveSamples, &openSamples, &scanSamples, &loadSamples })
+                std::sort(samples->begin(), samples->end());
+
+            char label[32];
+            std::snprintf(label, sizeof(label), "%dx%d", grid, grid);
+            std::printf("%10s %10d %10.1f %10.2f %10.1f %10.2f %10.2f %6s\n", label, grid * grid,
+                DungeonFile::fileSize(grid, grid, map.getRoomWidth(), map.getRoomHeight()) / (1024.0 * 1024.0), saveSamples[runs / 2],
+                openSamples[runs / 2], scanSamples[runs / 2], loadSamples[runs / 2],
+                same && walls > 0 ? "yes" : "NO");
+        }
+        return allSame;
+    }
+
+    bool broadphaseReport(int runs)
+    {
+        std::printf("broadphase, zombie sized boxes, room tile sized cells, median of %d ticks\n\n", 10 * runs);
+        std::printf("%8s %10s %10s %10s %12s %12s %10s %10s\n",
+            "boxes", "build us", "pairs us", "radius us", "naive us", "speedup", "pairs", "same");
+
+        bool allSame = true;
+        for (int count : { 1000, 10000, 50000 })
+        {
+            // area grows with the count so the crowd stays about as dense as a busy room
+            const float tileWidth = 120.f;
+            const float tileHeight = 100.f;
+            const int cells = static_cast<int>(std::ceil(std::sqrt(count / 4.0)));
+
+            Rng rng = Rng::stream(BENCH_SEED, 3, count);
+            std::vector<Aabb> boxes(count);
+            for (Aabb& box : boxes)
+            {
+                box = { static_cast<float>(rng.nextInt(static_cast<int>(cells * tileWidth))),
+                    static_cast<float>(rng.nextInt(static_cast<int>(cells * tileHeight))), 28.8f, 15.4f };
+            }
+
+            SpatialGrid grid;
+            grid.configure(tileWidth, tileHeight, cells, cells);
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+            std::vector<std::uint32_t> found;
+            std::vector<double> buildSamples;
+            std::vector<double> pairSamples;
+            std::vector<double> radiusSamples;
+            for (int tick = 0; tick < 10 * runs; ++tick)
+            {
+                auto start = std::chrono::steady_clock::now();
+                grid.build(boxes.data(), boxes.size());
+                buildSamples.push_back(elapsedMs(start) * 1000.0);
+
+                start = std::chrono::steady_clock::now();
+                grid.overlapPairs(pairs);
+                pairSamples.push_back(elapsedMs(start) * 1000.0);
+
+                // one radius query per 10 boxes, the player plus a few attackers
+                start = std::chrono::steady_clock::now();
+                for (int i = 0; i < count; i += 10)
+                    grid.queryRadius(boxes[i].left, boxes[i].top, 150.f, found);
+                radiusSamples.push_back(elapsedMs(start) * 1000.0);
+            }
+            std::sort(buildSamples.begin(), buildSamples.end());
+            std::sort(pairSamples.begin(), pairSamples.end());
+            std::sort(radiusSamples.begin(), radiusSamples.end());
+
+            // the naive version, once, it is the slow one
+            auto start = std::chrono::steady_clock::now();
+            std::size_t naivePairs = 0;
+            for (int i = 0; i < count; ++i)
+                for (int j = i + 1; j < count; ++j)
+                    naivePairs += intersects(boxes[i], boxes[j]);
+            double naiveUs = elapsedMs(start) * 1000.0;
+
+            const double buildUs = buildSamples[buildSamples.size() / 2];
+            const double pairsUs = pairSamples[pairSamples.size() / 2];
+            bool same = naivePairs == pairs.size();
+            allSame = allSame && same;
+            std::printf("%8d %10.1f %10.1f %10.1f %12.1f %11.0fx %10zu %10s\n", count, buildUs, pairsUs,
+                radiusSamples[radiusSamples.size() / 2], naiveUs, naiveUs / (buildUs + pairsUs),
+                pairs.size(), same ? "yes" : "NO");
+        }
+        return allSame;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const char* mode = argc > 1 ? argv[1] : "throughput";
+    bool scaling = std::strcmp(mode, "scaling") == 0;
+    int maxGrid = argc > 2 ? std::atoi(argv[2]) : (scaling ? 512 : 4096);
+    int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 5;
+
+    if (scaling)
+        return scalingReport(maxGrid, runs) ? 0 : 1;
+    if (std::strcmp(mode, "zombies") == 0)
+        return zombiesReport(runs) ? 0 : 1;
+    if (std::strcmp(mode, "broadphase") == 0)
+        return broadphaseReport(runs) ? 0 : 1;
+    if (std::strcmp(mode, "connectivity") == 0)
+        return connectivityReport(maxGrid, runs) ? 0 : 1;
+    if (std::strcmp(mode, "bitboard") == 0)
+        return bitboardReport(maxGrid, runs) ? 0 : 1;
+    if (std::strcmp(mode, "doors") == 0)
+        return doorsReport(runs) ? 0 : 1;
+    if (std::strcmp(mode, "caves") == 0)
+        return cavesReport(runs) ? 0 : 1;
+    if (std::strcmp(mode, "dungeonfile") == 0)
+        return dungeonFileReport(maxGrid, runs) ? 0 : 1;
+    if (std::strcmp(mode, "roompath") == 0)
+    {
+        roomPathReport(maxGrid, runs);
+        return 0;
+    }
+    if (std::strcmp(mode, "flowfield") == 0)
+    {
+        flowFieldReport(runs);
+        return 0;
+    }
+
+    throughputReport(maxGrid, runs);
+    return 0;
+}